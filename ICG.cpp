@@ -1,6 +1,18 @@
 
 #include "ICG.h"
-#include <math.h> // using: sqrt ( ), log ( )
+#include "ICGStats.h"
+#include <math.h> // using: sqrt ( ), log ( ), cos ( )
+#include <string.h> // using: memcpy ( ), memcmp ( )
+#if defined ( __BMI2__ )
+#include <immintrin.h> // using: _pdep_u64 ( )
+#endif
+
+// Instrumentation (see ICGStats.h): adds n to an ICGStats counter, or compiles to nothing.
+#if defined ( ICG_STATS )
+#define ICG_STATS_ADD( counter, n ) ( counters.counter += ( n ) )
+#else
+#define ICG_STATS_ADD( counter, n ) ( ( void ) sizeof ( n ) )
+#endif
 
 /**
  * Constructs an inversive congruential generator from the given parameters p, a, b and seed.
@@ -17,9 +29,11 @@
  * @param seed An unsigned long < p
  */
 ICG :: ICG ( unsigned long p, unsigned long a, unsigned long b, unsigned long seed )
-: generatorIsValid ( false ), p ( p ), a ( a ), b ( b ), seed ( seed ), curRand ( seed )
+: generatorIsValid ( false ), p ( p ), a ( a ), b ( b ), seed ( seed ), curRand ( seed ),
+  mullerNormal ( 0.0 ), useMullerNormal ( false ), constantWork ( false )
 {
 	checkGeneratorIsValid ( );
+	resetBitPool ( );
 }
 
 
@@ -42,6 +56,7 @@ bool ICG :: reparametrize ( unsigned long p, unsigned long a, unsigned long b, u
 	curRand = seed;
 
 	checkGeneratorIsValid ( );
+	resetBitPool ( );
 	return generatorIsValid;
 }
 
@@ -59,11 +74,237 @@ bool ICG :: reseed ( unsigned long newSeed ) {
 	curRand = seed;
 	
 	checkGeneratorIsValid ( );
+	resetBitPool ( );
 
 	return generatorIsValid;
 }
 		
 
+/**
+ * Advances the generator far ahead in the sequence in O ( log ( steps ) ) time.
+ *
+ * On the projective line over F_p (the residues mod p plus a point at infinity), the generation step
+ * is the Moebius map T ( x ) = ( b * x + a ) / x with the matrix M = [ b a ; 1 0 ]: it maps 0 to infinity
+ * and infinity to b, whereas rand ( ) maps 0 to b directly. The sequence of rand ( ) is therefore the
+ * orbit of T with the point at infinity left out, and steps applications of T are computed as M^steps
+ * by repeated squaring.
+ *
+ * The result equals steps calls of rand ( ), except when the skipped part of the sequence contains
+ * the value 0: then T's detour through infinity counts as a step and the generator ends up one value
+ * earlier. Jumps by multiples of a segment length therefore cut the cycle into segments that overlap
+ * in at most one value, which is what parallel substreams need.
+ *
+ * The cached normal value and the bit pool are discarded.
+ *
+ * @param steps The number of steps of T to advance.
+ */
+void ICG :: jump ( unsigned long long steps ) {
+	if ( !generatorIsValid ) return;
+
+	// R = M^steps
+	unsigned long long r00 = 1, r01 = 0, r10 = 0, r11 = 1;
+	unsigned long long m00 = b, m01 = a, m10 = 1, m11 = 0;
+	while ( steps != 0 ) {
+		if ( steps & 1 ) {
+			unsigned long long t00 = ( mulMod ( r00, m00 ) + mulMod ( r01, m10 ) ) % p;
+			unsigned long long t01 = ( mulMod ( r00, m01 ) + mulMod ( r01, m11 ) ) % p;
+			unsigned long long t10 = ( mulMod ( r10, m00 ) + mulMod ( r11, m10 ) ) % p;
+			unsigned long long t11 = ( mulMod ( r10, m01 ) + mulMod ( r11, m11 ) ) % p;
+			r00 = t00; r01 = t01; r10 = t10; r11 = t11;
+		}
+		unsigned long long t00 = ( mulMod ( m00, m00 ) + mulMod ( m01, m10 ) ) % p;
+		unsigned long long t01 = ( mulMod ( m00, m01 ) + mulMod ( m01, m11 ) ) % p;
+		unsigned long long t10 = ( mulMod ( m10, m00 ) + mulMod ( m11, m10 ) ) % p;
+		unsigned long long t11 = ( mulMod ( m10, m01 ) + mulMod ( m11, m11 ) ) % p;
+		m00 = t00; m01 = t01; m10 = t10; m11 = t11;
+		steps >>= 1;
+	}
+
+	// ( num : den ) = R * ( cur : 1 )
+	unsigned long long num = ( mulMod ( r00, curRand ) + r01 ) % p;
+	unsigned long long den = ( mulMod ( r10, curRand ) + r11 ) % p;
+
+	// Infinity is followed by b, just like 0 in rand ( ).
+	curRand = ( den == 0 ) ? 0 : mulMod ( num, inverse ( ( unsigned long ) den ) );
+
+	useMullerNormal = false;
+	resetBitPool ( );
+}
+
+
+static const unsigned char STATE_MAGIC [ 4 ] = { 'I', 'C', 'G', 'S' };
+static const unsigned char BANK_MAGIC [ 4 ] = { 'I', 'C', 'G', 'B' };
+static const unsigned STATE_VERSION = 1;
+static const size_t BANK_HEADER_SIZE = 16;
+
+static void putLE ( unsigned char * out, unsigned long long value, int bytes ) {
+	for ( int i = 0; i < bytes; i++ ) out [ i ] = ( unsigned char ) ( value >> ( 8 * i ) );
+}
+
+static unsigned long long getLE ( const unsigned char * in, int bytes ) {
+	unsigned long long value = 0;
+	for ( int i = bytes - 1; i >= 0; i-- ) value = ( value << 8 ) | in [ i ];
+	return value;
+}
+
+/**
+ * Checks that a record has the format written by serialize ( ) and a consistent content:
+ * a bit pool value inside its range, a current value < p, and no constant-work flag on a platform
+ * without that mode. Whether the parameters form a valid generator is left to checkGeneratorIsValid ( ).
+ */
+static bool isStateRecord ( const unsigned char * in ) {
+	if ( memcmp ( in, STATE_MAGIC, 4 ) != 0 || getLE ( in + 4, 2 ) != STATE_VERSION ) return false;
+
+	unsigned flags = ( unsigned ) getLE ( in + 6, 1 );
+	unsigned count = ( unsigned ) getLE ( in + 7, 1 );
+	unsigned long long p = getLE ( in + 8, 8 ), cur = getLE ( in + 40, 8 );
+	unsigned long long poolValue = getLE ( in + 56, 8 ), poolRange = getLE ( in + 64, 8 );
+	unsigned long long buffer = getLE ( in + 72, 8 );
+
+	if ( ( flags & ~3U ) != 0 || count > 32 || ( buffer >> count ) != 0 ) return false;
+	if ( poolRange == 0 || poolValue >= poolRange || ( p != 0 && cur >= p ) ) return false;
+#if !defined ( __SIZEOF_INT128__ )
+	if ( flags & 2 ) return false;
+#endif
+	return true;
+}
+
+
+/**
+ * Writes the complete generator state to a fixed-size record.
+ *
+ * The record holds everything that influences future outputs: the parameters, the seed, the current value,
+ * the cached normal value, the bit pool and the constant-work flag. Restoring it with deserialize ( )
+ * continues the sequences of all generation methods exactly where this generator is now.
+ *
+ * Layout (little-endian, STATE_SIZE bytes):
+ *
+ * 	offset  size
+ * 	     0     4  magic "ICGS"
+ * 	     4     2  format version (1)
+ * 	     6     1  flags: bit 0 normal value cached, bit 1 constant-work mode
+ * 	     7     1  number of buffered bits for randBit ( )
+ * 	     8     8  p
+ * 	    16     8  a
+ * 	    24     8  b
+ * 	    32     8  seed
+ * 	    40     8  current value
+ * 	    48     8  cached normal value, IEEE 754 bits
+ * 	    56     8  bit pool value
+ * 	    64     8  bit pool range
+ * 	    72     8  buffered bits for randBit ( )
+ *
+ * @param out Receives STATE_SIZE bytes.
+ */
+void ICG :: serialize ( unsigned char * out ) const {
+	unsigned long long normalBits;
+	memcpy ( &normalBits, &mullerNormal, sizeof ( normalBits ) );
+
+	memcpy ( out, STATE_MAGIC, 4 );
+	putLE ( out + 4, STATE_VERSION, 2 );
+	putLE ( out + 6, ( useMullerNormal ? 1 : 0 ) | ( constantWork ? 2 : 0 ), 1 );
+	putLE ( out + 7, bitBufferCount, 1 );
+	putLE ( out + 8, p, 8 );
+	putLE ( out + 16, a, 8 );
+	putLE ( out + 24, b, 8 );
+	putLE ( out + 32, seed, 8 );
+	putLE ( out + 40, curRand, 8 );
+	putLE ( out + 48, normalBits, 8 );
+	putLE ( out + 56, bitPoolValue, 8 );
+	putLE ( out + 64, bitPoolRange, 8 );
+	putLE ( out + 72, bitBuffer, 8 );
+}
+
+
+/**
+ * Restores a state written by serialize ( ).
+ *
+ * Records of other formats or versions, and records that are inconsistent (a bit pool value outside
+ * its range, a current value >= p, or the constant-work mode on a platform without it) are rejected
+ * and leave the generator unchanged.
+ *
+ * @param in A record of STATE_SIZE bytes.
+ * @return True iff the record was accepted and the restored generator is valid.
+ */
+bool ICG :: deserialize ( const unsigned char * in ) {
+	if ( !isStateRecord ( in ) ) return false;
+
+	unsigned flags = ( unsigned ) getLE ( in + 6, 1 );
+	unsigned long long normalBits = getLE ( in + 48, 8 );
+
+	generatorIsValid = false;
+	p = getLE ( in + 8, 8 );
+	a = getLE ( in + 16, 8 );
+	b = getLE ( in + 24, 8 );
+	seed = getLE ( in + 32, 8 );
+	checkGeneratorIsValid ( );
+
+	curRand = getLE ( in + 40, 8 );
+	memcpy ( &mullerNormal, &normalBits, sizeof ( normalBits ) );
+	useMullerNormal = ( flags & 1 ) != 0;
+	constantWork = ( flags & 2 ) != 0;
+	bitPoolValue = getLE ( in + 56, 8 );
+	bitPoolRange = getLE ( in + 64, 8 );
+	bitBuffer = ( unsigned long ) getLE ( in + 72, 8 );
+	bitBufferCount = ( unsigned ) getLE ( in + 7, 1 );
+
+	return generatorIsValid;
+}
+
+
+/**
+ * Returns the size of a bank of n generator states written by serializeBank ( ).
+ *
+ * @param n The number of generators.
+ * @return The size in bytes: a 16 byte header and n records of STATE_SIZE bytes.
+ */
+size_t ICG :: bankSize ( size_t n ) {
+	return BANK_HEADER_SIZE + n * STATE_SIZE;
+}
+
+
+/**
+ * Writes the states of n generators to one contiguous block, so a checkpoint of a whole bank is a single write.
+ *
+ * The block starts with a header (magic "ICGB", format version as 4 bytes, generator count as 8 bytes,
+ * little-endian), followed by the serialize ( ) records in order.
+ *
+ * @param gens The generators.
+ * @param n The number of generators.
+ * @param out Receives bankSize ( n ) bytes.
+ */
+void ICG :: serializeBank ( const ICG * gens, size_t n, unsigned char * out ) {
+	memcpy ( out, BANK_MAGIC, 4 );
+	putLE ( out + 4, STATE_VERSION, 4 );
+	putLE ( out + 8, n, 8 );
+	for ( size_t i = 0; i < n; i++ ) gens [ i ].serialize ( out + BANK_HEADER_SIZE + i * STATE_SIZE );
+}
+
+
+/**
+ * Restores the states of n generators from a block written by serializeBank ( ).
+ *
+ * The block is checked as a whole before anything is restored: if its header or any record is rejected,
+ * all generators are left unchanged.
+ *
+ * @param gens The generators to restore.
+ * @param n The number of generators, which must equal the count in the block.
+ * @param in A block of bankSize ( n ) bytes.
+ * @return True iff the block was accepted and all restored generators are valid.
+ */
+bool ICG :: deserializeBank ( ICG * gens, size_t n, const unsigned char * in ) {
+	if ( memcmp ( in, BANK_MAGIC, 4 ) != 0 || getLE ( in + 4, 4 ) != STATE_VERSION || getLE ( in + 8, 8 ) != n ) return false;
+
+	for ( size_t i = 0; i < n; i++ ) {
+		if ( !isStateRecord ( in + BANK_HEADER_SIZE + i * STATE_SIZE ) ) return false;
+	}
+
+	bool allValid = true;
+	for ( size_t i = 0; i < n; i++ ) allValid = gens [ i ].deserialize ( in + BANK_HEADER_SIZE + i * STATE_SIZE ) && allValid;
+	return allValid;
+}
+
+
 /**
  * Generates a pseudorandom unsigned integer between 0 and p-1 inclusive where p is the generator's prime number.
  *
@@ -72,7 +313,12 @@ bool ICG :: reseed ( unsigned long newSeed ) {
  * @return A random unsigned integer in the range 0, 1, 2, ..., p-1
  */
 unsigned long ICG :: rand ( ) {
-	if ( !generatorIsValid ) return 0;
+	ICG_STATS_ADD ( randCalls, 1 );
+	if ( !generatorIsValid ) {
+		ICG_STATS_ADD ( invalidZeroReturns, 1 );
+		return 0;
+	}
+	if ( constantWork ) return constantWorkRand ( );
 	
 	if ( curRand == 0 ) { curRand = ( unsigned long ) b; return curRand; }
 	
@@ -81,8 +327,14 @@ unsigned long ICG :: rand ( ) {
 
 	// The class variables p, a, b are stored internally as unsigned long long values yet
 	// never take on values greater than MAX ( unsigned long ).
+	// For primes above 2^32 the product a * inv needs more than 64 bits.
 	unsigned long long inv = inverse ( curRand );
-	unsigned long long temp = ( a * inv + b ) % p;
+	unsigned long long temp;
+#if defined ( __SIZEOF_INT128__ )
+	if ( p > 0xFFFFFFFFULL ) temp = ( unsigned long long ) ( ( ( unsigned __int128 ) a * inv + b ) % p );
+	else
+#endif
+	temp = ( a * inv + b ) % p;
 	
 	curRand = ( unsigned long ) ( temp );
 	
@@ -90,6 +342,42 @@ unsigned long ICG :: rand ( ) {
 }
 
 
+/**
+ * Writes the next n outputs of rand ( ) into a buffer.
+ *
+ * Produces exactly the same values as n calls of rand ( ), and in fact calls rand ( ) once per value:
+ * every step depends on the previous one, so a single stream cannot be batched. Consumers that work on
+ * blocks (e.g. ICGRanges.h) only save their own per-value overhead; many streams can be stepped
+ * together with ICGKernels :: step ( ).
+ *
+ * @param out Buffer receiving n random unsigned integers in the range 0, 1, 2, ..., p-1.
+ * @param n The number of values.
+ */
+void ICG :: fill ( unsigned long * out, size_t n ) {
+	for ( size_t i = 0; i < n; i++ ) out [ i ] = rand ( );
+}
+
+
+/**
+ * Writes the next n outputs of rand01 ( ) into a buffer.
+ *
+ * The values are bit-identical to those of n calls of rand01 ( ).
+ *
+ * @param out Buffer receiving n random doubles in the interval [0,1).
+ * @param n The number of values.
+ */
+void ICG :: fill01 ( double * out, size_t n ) {
+	if ( !generatorIsValid ) {
+		ICG_STATS_ADD ( invalidZeroReturns, n );
+		for ( size_t i = 0; i < n; i++ ) out [ i ] = 0.0;
+		return;
+	}
+
+	const double denominator = ( double ) p;
+	for ( size_t i = 0; i < n; i++ ) out [ i ] = ( double ) rand ( ) / denominator;
+}
+
+
 /**
  * Generates a pseudorandom unsigned integer between 0 and range-1 inclusive.
  *
@@ -103,6 +391,234 @@ unsigned long ICG :: rand ( unsigned long range ) {
 }
 
 
+/**
+ * Generates an exactly uniformly distributed pseudorandom unsigned integer between 0 and range-1 inclusive.
+ *
+ * Unlike rand ( range ), which rounds rand01 ( ) * range and thus slightly favours some values,
+ * this method rejects the few raw outputs that would bias the result.
+ * For ranges up to about 2^64 / p the common path is Lemire's multiply-and-compare method
+ * carried out in base p: the product rand ( ) * range is split into quotient and remainder
+ * modulo p with a precomputed reciprocal, so no hardware division is needed.
+ * Larger ranges combine several generator outputs, or without 128 bit integers, for ranges above
+ * about 2^64 / p, reject on rand64 ( ).
+ *
+ * @param range The largest generated number is given by range-1.
+ * @return A random unsigned integer in the range 0, 1, 2, ..., range-1, or 0 if range is 0.
+ */
+unsigned long ICG :: randBounded ( unsigned long range ) {
+	if ( !generatorIsValid ) {
+		ICG_STATS_ADD ( invalidZeroReturns, 1 );
+		return 0;
+	}
+	if ( range == 0 ) return 0;
+
+	if ( range <= p && range <= pReciprocal ) {
+		// rand ( ) * range = q * p + r, with rand ( ) * range < 2^64.
+		// Each q is hit equally often once the products with r < p % range are rejected.
+		unsigned long long threshold = 0;
+		bool haveThreshold = false;
+		for ( ;; ) {
+			unsigned long long m = ( unsigned long long ) rand ( ) * range;
+#if defined ( __SIZEOF_INT128__ )
+			unsigned long long q = ( unsigned long long ) ( ( ( unsigned __int128 ) m * pReciprocal ) >> 64 );
+			unsigned long long r = m - q * p;
+			while ( r >= p ) { r -= p; q++; }
+#else
+			unsigned long long q = m / p, r = m % p;
+#endif
+			// p % range < range, so the remainder check only needs a division in rare cases.
+			if ( r >= range ) return ( unsigned long ) q;
+			if ( !haveThreshold ) { threshold = p % range; haveThreshold = true; }
+			if ( r >= threshold ) return ( unsigned long ) q;
+		}
+	}
+
+	// Slow path: combine digits x = rand ( ) * p^(k-1) + ... + rand ( ) uniform in [0, p^k) with p^k >= range,
+	// and reject the incomplete top block.
+#if defined ( __SIZEOF_INT128__ )
+	typedef unsigned __int128 wide_t;
+#else
+	typedef unsigned long long wide_t;
+#endif
+	wide_t n = 1;
+	while ( n < range ) {
+		if ( n > ( ( wide_t ) ~( wide_t ) 0 ) / p ) {
+			// p^k would overflow wide_t: reject on full 64 bit words instead, 2^64 % range of which are biased
+			unsigned long long threshold = ( 0 - ( unsigned long long ) range ) % range, w;
+			do w = rand64 ( ); while ( w < threshold );
+			return ( unsigned long ) ( w % range );
+		}
+		n *= p;
+	}
+	wide_t limit = n - n % range, x;
+	do {
+		x = 0;
+		for ( wide_t k = 1; k < n; k *= p ) x = x * p + rand ( );
+	} while ( x >= limit );
+
+	return ( unsigned long ) ( x % range );
+}
+
+
+/**
+ * Generates k uniformly distributed random bits.
+ *
+ * Since p is not a power of two, a single output cannot simply be cut into bits.
+ * Instead, generator outputs are merged into a pool value v that is uniform in [0, m):
+ * a new output x turns it into v * p + x, uniform in [0, m * p).
+ * With m = c * 2^k + r, the k low bits of v are uniform whenever v < c * 2^k, and v / 2^k remains
+ * uniform in [0, c) for later requests. Otherwise v - c * 2^k is uniform in [0, r) and is kept too.
+ * Hardly any entropy is discarded, so a coin flip costs about 1 / log2 ( p ) generator steps
+ * instead of the full step spent by rand ( 2 ).
+ *
+ * @param k The number of bits, at most 32.
+ * @return A random unsigned integer in the range 0, 1, ..., 2^k - 1, or 0 if the generator is invalid.
+ */
+unsigned long ICG :: randBits ( unsigned k ) {
+	if ( !generatorIsValid ) {
+		ICG_STATS_ADD ( invalidZeroReturns, 1 );
+		return 0;
+	}
+	if ( k == 0 ) return 0;
+	if ( k > 32 ) k = 32;
+
+	const unsigned long long pow2k = 1ULL << k;
+
+	for ( ;; ) {
+		// Merge outputs while v * p + x cannot overflow.
+		while ( bitPoolRange <= pReciprocal ) {
+			bitPoolValue = bitPoolValue * p + rand ( );
+			bitPoolRange *= p;
+		}
+
+		// Only happens for p > 2^32: start over from a single output.
+		if ( bitPoolRange < pow2k ) {
+			bitPoolValue = 0;
+			bitPoolRange = 1;
+			continue;
+		}
+
+		unsigned long long c = bitPoolRange >> k;
+		if ( bitPoolValue < ( c << k ) ) {
+			unsigned long bits = ( unsigned long ) ( bitPoolValue & ( pow2k - 1 ) );
+			bitPoolValue >>= k;
+			bitPoolRange = c;
+			return bits;
+		}
+
+		bitPoolValue -= c << k;
+		bitPoolRange &= pow2k - 1;
+	}
+}
+
+
+/**
+ * Fills a buffer with uniformly distributed random bits.
+ *
+ * @param words Buffer receiving n random 64 bit words.
+ * @param n The number of words.
+ */
+void ICG :: fillBits ( unsigned long long * words, size_t n ) {
+	for ( size_t i = 0; i < n; i++ ) words [ i ] = rand64 ( );
+}
+
+
+/**
+ * Fills a buffer with uniformly distributed random bytes.
+ *
+ * The bytes are cut from the same bit pool as randBits ( ), so about n / ( log2 ( p ) / 8 ) generator
+ * steps are needed. Words are stored least significant byte first, so the byte stream is the same
+ * on every platform.
+ *
+ * @param buffer Buffer receiving n random bytes. Needs no particular alignment.
+ * @param n The number of bytes.
+ */
+void ICG :: fillBytes ( void * buffer, size_t n ) {
+	unsigned char * out = ( unsigned char * ) buffer;
+
+	while ( n >= 4 ) {
+		unsigned long word = randBits ( 32 );
+		out [ 0 ] = ( unsigned char ) word;
+		out [ 1 ] = ( unsigned char ) ( word >> 8 );
+		out [ 2 ] = ( unsigned char ) ( word >> 16 );
+		out [ 3 ] = ( unsigned char ) ( word >> 24 );
+		out += 4;
+		n -= 4;
+	}
+
+	if ( n > 0 ) {
+		unsigned long word = randBits ( ( unsigned ) ( 8 * n ) );
+		for ( size_t i = 0; i < n; i++ ) out [ i ] = ( unsigned char ) ( word >> ( 8 * i ) );
+	}
+}
+
+
+/**
+ * Fills a packed bitmask with independent Bernoulli ( prob ) bits.
+ *
+ * Bit i of the mask is words [ i / 64 ] >> ( i % 64 ) & 1. Each bit is set iff a uniform number U,
+ * revealed one binary digit at a time, is smaller than prob. Comparing the digits of U with the binary
+ * expansion of prob decides a bit with probability 1/2 per digit, so on average two random bits are
+ * consumed per output bit, independently of prob.
+ * The comparison is bit-sliced: all 64 lanes of a word compare the same digit of prob at once, and
+ * fresh random digits are only drawn for the lanes that are still undecided.
+ * Unused bits of the last word are cleared.
+ *
+ * @param words Buffer of ( nbits + 63 ) / 64 words receiving the mask.
+ * @param nbits The number of Bernoulli bits.
+ * @param prob The probability of a bit being set; values outside [0,1] are clamped.
+ */
+void ICG :: fillBernoulliMask ( unsigned long long * words, size_t nbits, double prob ) {
+	size_t nwords = ( nbits + 63 ) / 64;
+
+	for ( size_t w = 0; w < nwords; w++ ) {
+		unsigned long long lanes = ( w + 1 < nwords || nbits % 64 == 0 ) ? ~0ULL : ( 1ULL << ( nbits % 64 ) ) - 1;
+
+		if ( !generatorIsValid || !( prob > 0.0 ) ) { words [ w ] = 0; continue; }
+		if ( prob >= 1.0 ) { words [ w ] = lanes; continue; }
+
+		unsigned long long result = 0, undecided = lanes;
+		double rest = prob;
+
+		// Once the remaining digits of prob are all zero, U >= prob in every undecided lane.
+		while ( undecided != 0 && rest > 0.0 ) {
+			rest *= 2.0;
+			bool digit = ( rest >= 1.0 );
+			if ( digit ) rest -= 1.0;
+
+			// Scatter one fresh random digit into every undecided lane.
+#if defined ( __GNUC__ )
+			unsigned k = ( unsigned ) __builtin_popcountll ( undecided );
+#else
+			unsigned k = 0;
+			for ( unsigned long long m = undecided; m != 0; m &= m - 1 ) k++;
+#endif
+			unsigned long long r = randBits ( k > 32 ? 32 : k );
+			if ( k > 32 ) r |= ( unsigned long long ) randBits ( k - 32 ) << 32;
+#if defined ( __BMI2__ )
+			unsigned long long u = _pdep_u64 ( r, undecided );
+#else
+			unsigned long long u = 0;
+			for ( unsigned long long m = undecided; m != 0; m &= m - 1, r >>= 1 ) {
+				if ( r & 1 ) u |= m & ( ~m + 1 );
+			}
+#endif
+
+			if ( digit ) {
+				// digit of U is 0 < 1: U < prob
+				result |= undecided & ~u;
+				undecided &= u;
+			} else {
+				// digit of U is 1 > 0: U > prob
+				undecided &= ~u;
+			}
+		}
+
+		words [ w ] = result;
+	}
+}
+
+
 /**
  * Generates a pseudorandom double precision floating point number in the intervall [0,1).
  *
@@ -111,7 +627,10 @@ unsigned long ICG :: rand ( unsigned long range ) {
  * @return A random double in the interval [0,1).
  */
 double ICG :: rand01 ( ) {
-	if ( !generatorIsValid ) return 0;
+	if ( !generatorIsValid ) {
+		ICG_STATS_ADD ( invalidZeroReturns, 1 );
+		return 0;
+	}
 	
 	return ( ( double ) rand ( ) / ( double ) p );
 }
@@ -127,7 +646,10 @@ double ICG :: rand01 ( ) {
  * @return A random double in the intervall [A,B).
  */
 double ICG :: randInterval ( double A, double B ) {
-	if ( !generatorIsValid ) return 0;
+	if ( !generatorIsValid ) {
+		ICG_STATS_ADD ( invalidZeroReturns, 1 );
+		return 0;
+	}
 
 	if ( B == A ) return A;
 	if ( B < A ) {
@@ -160,27 +682,46 @@ double ICG :: randNormal ( double mu, double ss ) {
  *
  * Uses the Box-Muller method in polar form to produce standard normally distributed
  * numbers from evenly distributed ICG output.
+ * In constant-work mode the trigonometric form is used instead, see setConstantWork ( ).
  *
- * @return A roughly Z=N(0,1) distributed pseudorandom number.
+ * @return A roughly Z=N(0,1) distributed pseudorandom number, or 0 if the generator is invalid.
  */
 double ICG :: randStdNorm ( ) {
+	// The polar method below would reject the constant uniforms of an invalid generator forever.
+	if ( !generatorIsValid ) {
+		ICG_STATS_ADD ( invalidZeroReturns, 1 );
+		return 0;
+	}
+
+	// Constant-work mode: the basic (trigonometric) Box-Muller transform needs exactly two uniforms
+	// and no rejection. The partner value is discarded, so every call does the same work.
+	if ( constantWork ) {
+		const double TWO_PI = 6.283185307179586476925286766559;
+		double u1 = 1.0 - rand01 ( ), u2 = rand01 ( );
+		return sqrt ( -2.0 * log ( u1 ) ) * cos ( TWO_PI * u2 );
+	}
+
 	// The Box-Muller method actually generates 2 random numbers, but
 	// this method only returns one.
 	// In order to avoid unnecessary calculation, we save the extra number (as a standard normal value)
 	// in a class variable and return it on the next call.
 	if ( useMullerNormal ) {
+		ICG_STATS_ADD ( normalCacheHits, 1 );
 		useMullerNormal = false;
 		return mullerNormal;
 	}
 
 	double u1 = 0.0, u2 = 0.0, q = 0.0;
 	const double EPS = 0.0001;
+	unsigned long long attempts = 0;
 	do {
 		u1 = randInterval ( -1.0, 1.0 );
 		u2 = randInterval ( -1.0, 1.0 );
 		q = u1 * u1 + u2 * u2;
+		attempts++;
 
 	} while ( q <= EPS || q > 1.0 );
+	ICG_STATS_ADD ( normalRejections, attempts - 1 );
 
 	double r = sqrt ( -2.0 * log ( q ) / q );
 
@@ -190,33 +731,200 @@ double ICG :: randStdNorm ( ) {
 }
 
 
+/**
+ * Switches the constant-work generation mode on or off.
+ *
+ * Normally the cost of rand ( ) varies with the number of iterations of the extended Euclidean
+ * algorithm in inverse ( ), and randStdNorm ( ) rejects about 21% of its candidates and returns every
+ * second value from a cache. Soft real-time code that needs predictable timing can enable this mode:
+ *
+ *  - rand ( ) computes the inverse as cur^(p-2) (Fermat's little theorem) with Montgomery multiplication.
+ *    The exponent is fixed, so every call performs the same sequence of multiplications, with no
+ *    divisions and no data-dependent branches. The generated sequence is identical to the normal mode.
+ *  - randStdNorm ( ) uses the trigonometric Box-Muller transform on exactly two uniforms and returns one
+ *    value per pair, so every call performs the same work. This changes the normal sequence.
+ *
+ * The mode costs about 2 * log2 ( p ) multiplications per step and therefore lowers the mean throughput;
+ * it is meant for paths where tail latency matters more. It needs 128-bit integer support.
+ *
+ * @param enable True to enable the mode, false to return to the default algorithms.
+ * @return True iff the requested mode is active afterwards.
+ */
+bool ICG :: setConstantWork ( bool enable ) {
+#if defined ( __SIZEOF_INT128__ )
+	constantWork = enable;
+	useMullerNormal = false;
+	return true;
+#else
+	constantWork = false;
+	return !enable;
+#endif
+}
+
+
+/**
+ * Multiplies two residues mod p.
+ *
+ * Private helper method.
+ *
+ * @param x An unsigned integer < p
+ * @param y An unsigned integer < p
+ * @return ( x * y ) % p
+ */
+unsigned long long ICG :: mulMod ( unsigned long long x, unsigned long long y ) const {
+#if defined ( __SIZEOF_INT128__ )
+	if ( p > 0xFFFFFFFFULL ) return ( unsigned long long ) ( ( unsigned __int128 ) x * y % p );
+#endif
+	return x * y % p;
+}
+
+
+/**
+ * Montgomery product x * y / 2^64 mod p.
+ *
+ * Private helper method.
+ * Uses only multiplications, additions and a branch-free conditional subtraction.
+ *
+ * @param x An unsigned integer < p
+ * @param y An unsigned integer < p
+ * @return ( x * y * 2^-64 ) % p
+ */
+unsigned long long ICG :: montMul ( unsigned long long x, unsigned long long y ) const {
+#if defined ( __SIZEOF_INT128__ )
+	unsigned __int128 t = ( unsigned __int128 ) x * y;
+	unsigned long long m = ( unsigned long long ) t * montPInv;
+	// t + m * p < 2^128 since p < 2^63, and is divisible by 2^64
+	unsigned long long r = ( unsigned long long ) ( ( t + ( unsigned __int128 ) m * p ) >> 64 );
+	return r - ( p & ( 0ULL - ( unsigned long long ) ( r >= p ) ) );
+#else
+	return 0;
+#endif
+}
+
+
+/**
+ * Generation step of the constant-work mode.
+ *
+ * Private helper method.
+ * Computes next = ( a * cur^(p-2) + b ) % p, which equals ( a * inverse ( cur ) + b ) % p for cur != 0
+ * and b for cur == 0, exactly like rand ( ).
+ *
+ * @return The next random unsigned integer in the range 0, 1, 2, ..., p-1
+ */
+unsigned long ICG :: constantWorkRand ( ) {
+	unsigned long long base = montMul ( curRand, montR2 );		// cur * R
+	unsigned long long inv = montOne;							// 1 * R
+	const unsigned long long e = p - 2;
+	int top = 63;
+	while ( top > 0 && ( ( e >> top ) & 1 ) == 0 ) top--;
+
+	// Left-to-right square-and-multiply; the multiplication is always performed and selected without branching.
+	for ( int bit = top; bit >= 0; bit-- ) {
+		inv = montMul ( inv, inv );
+		unsigned long long product = montMul ( inv, base );
+		unsigned long long mask = 0ULL - ( ( e >> bit ) & 1 );
+		inv = ( product & mask ) | ( inv & ~mask );
+	}
+
+	ICG_STATS_ADD ( inversions, 1 );
+
+	// montA * inv / R = a * cur^-1 * R, one more reduction by R leaves a * cur^-1
+	unsigned long long next = montMul ( montMul ( montA, inv ), 1 ) + b;
+	next -= p & ( 0ULL - ( unsigned long long ) ( next >= p ) );
+
+	curRand = next;
+	return ( unsigned long ) curRand;
+}
+
+
+/**
+ * Returns a snapshot of the instrumentation counters.
+ * Must be called by the thread using this generator.
+ *
+ * @return The counts since construction or the last resetStats ( ); all 0 unless compiled with ICG_STATS.
+ */
+ICGStats ICG :: getStats ( ) const {
+#if defined ( ICG_STATS )
+	return counters;
+#else
+	return ICGStats ( );
+#endif
+}
+
+
+/**
+ * Sets the instrumentation counters to 0.
+ */
+void ICG :: resetStats ( ) {
+#if defined ( ICG_STATS )
+	counters = ICGStats ( );
+#endif
+}
+
+
 /**
  * Determines if a number is prime.
  *
- * Private helper method. Uses naive algorithm, since only called once upon construction.
+ * Small factors are removed by trial division. Larger numbers are tested with Miller-Rabin using
+ * the first twelve primes as bases, which is deterministic for all 64-bit integers, so primes up to
+ * 2^64 are recognised in microseconds. Without 128-bit integer support the test falls back to
+ * trial division up to sqrt ( pr ).
  *
  * @param pr A number to check for primeness.
  * @return True iff pr is a prime number.
  */
 bool ICG :: isPrime ( unsigned long pr ) {
-	if ( pr == 0 || pr == 1) return false;
-	if ( pr == 2 || pr == 3 ) return true;
-	if ( pr % 2 == 0 ) return false;
+	static const unsigned long bases [ ] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+	const int numBases = sizeof ( bases ) / sizeof ( bases [ 0 ] );
+
+	if ( pr < 2 ) return false;
+	for ( int i = 0; i < numBases; i++ ) {
+		if ( pr == bases [ i ] ) return true;
+		if ( pr % bases [ i ] == 0 ) return false;
+	}
+	if ( pr < 41 * 41 ) return true;
+
+#if defined ( __SIZEOF_INT128__ )
+	// pr - 1 = d * 2^s with d odd
+	unsigned long long d = pr - 1;
+	int s = 0;
+	while ( ( d & 1 ) == 0 ) { d >>= 1; s++; }
+
+	for ( int i = 0; i < numBases; i++ ) {
+		// x = bases [ i ] ^ d % pr
+		unsigned long long x = 1, base = bases [ i ], e = d;
+		while ( e != 0 ) {
+			if ( e & 1 ) x = ( unsigned long long ) ( ( unsigned __int128 ) x * base % pr );
+			base = ( unsigned long long ) ( ( unsigned __int128 ) base * base % pr );
+			e >>= 1;
+		}
 
-	unsigned long cur = 3, max = ( unsigned long ) ( sqrt ( pr ) );
+		if ( x == 1 || x == pr - 1 ) continue;
+
+		bool witness = true;
+		for ( int r = 1; r < s && witness; r++ ) {
+			x = ( unsigned long long ) ( ( unsigned __int128 ) x * x % pr );
+			if ( x == pr - 1 ) witness = false;
+		}
+		if ( witness ) return false;
+	}
+
+	return true;
+#else
+	unsigned long cur = 41, max = ( unsigned long ) ( sqrt ( pr ) );
 	while ( cur <= max ) {
 		if ( pr % cur == 0 ) return false;
 		cur += 2;
 	}
 
 	return true;
+#endif
 }
 
 
 /**
  * Calculates the inverse of an integer in the ring mod p.
  *
- * Private helper method.
  * If the passed integer is 0 or greater than p this function returns 0.
  * Uses the extended Euclidean algorithm to calculate the inverse of y such that
  *
@@ -225,7 +933,8 @@ bool ICG :: isPrime ( unsigned long pr ) {
  * @param y A nonzero unsigned long < p
  * @return An unsigned long integer z such that ( y*z % p ) == 1
  */
-unsigned long ICG :: inverse ( unsigned long y ) {
+unsigned long ICG :: inverse ( unsigned long y ) const {
+	ICG_STATS_ADD ( inversions, 1 );
 	if ( y == 0 ) return 0;
 	if ( y == 1 ) return 1;
 	if ( y >= p ) return 0;
@@ -233,9 +942,11 @@ unsigned long ICG :: inverse ( unsigned long y ) {
 	
 	unsigned long rn = p, rn1 = y, rn2 = rn % rn1;
 	long long Rn = 0, Rn1 = 1, Rn2 = 0, q = 0;
+	unsigned long long iterations = 0;
 	
 	// a = ( a / b ) * b + a % b
 	while ( rn2 != 0 ) {
+		iterations++;
 		rn2 = rn % rn1;
 		q = rn / rn1;
 		
@@ -250,26 +961,60 @@ unsigned long ICG :: inverse ( unsigned long y ) {
 		}
 	}
 	
+	ICG_STATS_ADD ( euclidIterations, iterations );
+
 	while ( Rn1 < 0 ) Rn1 += p;
 	return ( unsigned long ) Rn1;
 }
 
 
+/**
+ * Discards all buffered random bits.
+ *
+ * Private helper method.
+ * Called whenever the generator state is reset, so bit generation restarts with the new sequence.
+ */
+void ICG :: resetBitPool ( ) {
+	bitPoolValue = 0;
+	bitPoolRange = 1;
+	bitBuffer = 0;
+	bitBufferCount = 0;
+}
+
+
 /**
  * Sets the validity state of this ICG according to the current parameters.
  *
  * Private helper method.
  * In order to be a valid generator, the following conditions must be met:
  * 	 - p is prime and > 3
+ * 	 - p < 2^63, so the signed coefficients in inverse ( ) cannot overflow
  * 	 - a < p
  * 	 - b < p
  * 	 - seed < p
  *
+ * Also refreshes the reciprocal of p used by randBounded ( ) and the Montgomery constants
+ * of the constant-work mode.
  */
 void ICG :: checkGeneratorIsValid ( ) {
 	generatorIsValid = ( p > 3 ) &&
+					   ( p < ( 1ULL << 63 ) ) &&
 					   ( isPrime ( p ) ) &&
 					   ( a < p ) &&
 					   ( b < p ) &&
 					   ( seed < p );
+
+	pReciprocal = generatorIsValid ? ~0ULL / p : 0;
+
+#if defined ( __SIZEOF_INT128__ )
+	if ( generatorIsValid ) {
+		// Newton iteration for p^-1 mod 2^64, each step doubles the number of correct bits
+		unsigned long long inv = p;
+		for ( int i = 0; i < 5; i++ ) inv *= 2 - p * inv;
+		montPInv = 0 - inv;
+		montOne = ( ~0ULL % p + 1 ) % p;
+		montR2 = ( unsigned long long ) ( ( unsigned __int128 ) montOne * montOne % p );
+		montA = montMul ( a, montR2 );
+	}
+#endif
 }
@@ -2,6 +2,21 @@
 #ifndef __ICG_H__
 #define __ICG_H__
 
+#include <stddef.h> // using: size_t
+#include <algorithm> // using: std::iter_swap ( )
+#include <iterator> // using: std::iterator_traits
+
+// ICG_STATS adds the counters to class ICG, so the class is declared in a namespace named after the
+// setting: translation units compiled with different settings fail to link instead of silently sharing
+// generators of two layouts. Without ICG_STATS, ICGStats is only declared; include ICGStats.h to call getStats ( ).
+#if defined ( ICG_STATS )
+#include "ICGStats.h"
+#define ICG_ABI_NAMESPACE icg_stats_on
+#else
+struct ICGStats;
+#define ICG_ABI_NAMESPACE icg_stats_off
+#endif
+
 /**
  * Inversive congruential generator
  *
@@ -41,16 +56,118 @@
  *  // -INF < randStdNorm < INF, normally distributed, mu=5.0, sigma^2=2.0
  *  double randNorm = icg.randNormal ( 5.0, 2.0 );
  *
+ *  // 0 <= randExact < 100, exactly uniform (no rounding bias)
+ *  unsigned long randExact = icg.randBounded ( 100 );
+ *
+ *  // uniformly random permutation of a container
+ *  icg.shuffle ( v.begin ( ), v.end ( ) );
+ *
+ *  // fair coin flip and 10 uniform random bits
+ *  bool coin = icg.randBit ( );
+ *  unsigned long bits = icg.randBits ( 10 );
+ *
+ *  // full machine words and raw bytes, exactly uniform
+ *  unsigned long long word = icg.rand64 ( );
+ *  icg.fillBytes ( buffer, sizeof ( buffer ) );
+ *
+ *  // 1000 packed bits, each set with probability 0.3
+ *  unsigned long long mask [ 16 ];
+ *  icg.fillBernoulliMask ( mask, 1000, 0.3 );
+ *
+ *  // same sequence, but every rand ( ) and randStdNorm ( ) call does the same amount of work
+ *  icg.setConstantWork ( true );
+ *
+ *  // skip a billion values in O ( log n ) time, e.g. to give each thread its own segment of the sequence
+ *  icg.jump ( 1000000000ULL );
+ *
+ *  // cost counters (ICGStats.h), maintained when compiled with -DICG_STATS
+ *  ICGStats stats = icg.getStats ( );
+ *
+ *  // checkpoint the complete state and continue from it later, bit for bit
+ *  unsigned char state [ ICG :: STATE_SIZE ];
+ *  icg.serialize ( state );
+ *  icg.deserialize ( state );
+ *
  */
+namespace ICG_ABI_NAMESPACE {
+
 class ICG {
 	public:
 		ICG ( unsigned long p, unsigned long a, unsigned long b, unsigned long seed );
 		
 		bool reparametrize ( unsigned long a, unsigned long b, unsigned long p, unsigned long seed );
 		bool reseed ( unsigned long seed );
+		void jump ( unsigned long long steps );
+
+		// size in bytes of a record written by serialize ( )
+		static const size_t STATE_SIZE = 80;
+
+		void serialize ( unsigned char * out ) const;
+		bool deserialize ( const unsigned char * in );
+
+		static size_t bankSize ( size_t n );
+		static void serializeBank ( const ICG * gens, size_t n, unsigned char * out );
+		static bool deserializeBank ( ICG * gens, size_t n, const unsigned char * in );
 
 		unsigned long rand ( );
 		unsigned long rand ( unsigned long range );
+		unsigned long randBounded ( unsigned long range );
+
+		/**
+		 * Generates a uniformly distributed random bit.
+		 *
+		 * Bits are taken from a 32 bit buffer filled by randBits ( 32 ), so on average
+		 * about one generator step is needed per 24 bits with the default prime.
+		 *
+		 * @return A fair coin flip, or false if the generator is invalid.
+		 */
+		bool randBit ( ) {
+			if ( bitBufferCount == 0 ) {
+				bitBuffer = randBits ( 32 );
+				bitBufferCount = 32;
+			}
+			bool bit = ( bitBuffer & 1 ) != 0;
+			bitBuffer >>= 1;
+			bitBufferCount--;
+			return bit;
+		}
+
+		unsigned long randBits ( unsigned k );
+		void fillBits ( unsigned long long * words, size_t n );
+
+		/**
+		 * Generates a uniformly distributed 32 bit word.
+		 *
+		 * @return A random unsigned integer in the range 0, 1, ..., 2^32 - 1, or 0 if the generator is invalid.
+		 */
+		unsigned long rand32 ( ) { return randBits ( 32 ); }
+
+		/**
+		 * Generates a uniformly distributed 64 bit word.
+		 *
+		 * @return A random unsigned integer in the range 0, 1, ..., 2^64 - 1, or 0 if the generator is invalid.
+		 */
+		unsigned long long rand64 ( ) {
+			unsigned long long hi = randBits ( 32 );
+			return ( hi << 32 ) | randBits ( 32 );
+		}
+
+		void fillBytes ( void * buffer, size_t n );
+
+#if __cplusplus >= 201103L
+		/*
+		 * UniformRandomBitGenerator interface, so an ICG can be passed to std :: shuffle ( ) and the
+		 * <random> distributions. Each call yields a uniform 32 bit word from rand32 ( ).
+		 * ICGRandom.h provides distributions which use the native generation methods instead.
+		 */
+		typedef unsigned long result_type;
+
+		static constexpr result_type min ( ) { return 0; }
+		static constexpr result_type max ( ) { return 0xFFFFFFFFUL; }
+
+		result_type operator ( ) ( ) { return rand32 ( ); }
+#endif
+		void fillBernoulliMask ( unsigned long long * words, size_t nbits, double prob );
 
 		double rand01 ( );
 		double randInterval ( double A, double B );
@@ -58,6 +175,27 @@ class ICG {
 		double randNormal ( double mu, double ss );
 		double randStdNorm ( );
 
+		void fill ( unsigned long * out, size_t n );
+		void fill01 ( double * out, size_t n );
+
+		template < class RandomIt > void shuffle ( RandomIt first, RandomIt last );
+
+		unsigned long inverse ( unsigned long y ) const;
+
+		bool setConstantWork ( bool enable );
+
+		/**
+		 * Returns whether the constant-work generation mode is active.
+		 *
+		 * @return True iff setConstantWork ( true ) has been called successfully.
+		 */
+		bool isConstantWork ( ) const { return constantWork; }
+
+		static bool isPrime ( unsigned long pr );
+
+		ICGStats getStats ( ) const;
+		void resetStats ( );
+
 		/**
 		 * Returns the validity state of the generator.
 		 *
@@ -90,6 +228,15 @@ class ICG {
 		 */
 		unsigned long get_b ( ) const { return b; }
 
+		/**
+		 * Returns this generator's state: the last value of rand ( ), or the seed before the first call.
+		 *
+		 * reseed ( get_state ( ) ) on a generator with the same parameters continues with the same values of rand ( ).
+		 *
+		 * @return The state, in 0, 1, 2, ..., p-1.
+		 */
+		unsigned long get_state ( ) const { return ( unsigned long ) curRand; }
+
 	private:
 		bool generatorIsValid;
 
@@ -98,10 +245,76 @@ class ICG {
 		double mullerNormal;
 		bool useMullerNormal;
 
+		// floor ( ( 2^64 - 1 ) / p ), used to reduce modulo p without a hardware divide
+		unsigned long long pReciprocal;
+
+		// bitPoolValue is uniformly distributed in [0, bitPoolRange); see randBits ( )
+		unsigned long long bitPoolValue, bitPoolRange;
+		unsigned long bitBuffer;
+		unsigned bitBufferCount;
+
+		// Montgomery arithmetic for the constant-work mode, with R = 2^64:
+		// montPInv = -p^-1 mod R, montR2 = R^2 mod p, montOne = R mod p, montA = a * R mod p
+		bool constantWork;
+		unsigned long long montPInv, montR2, montOne, montA;
+
+#if defined ( ICG_STATS )
+		// mutable, since the const inverse ( ) counts as well
+		mutable ICGStats counters;
+#endif
+
 		void checkGeneratorIsValid ( );
+		void resetBitPool ( );
 
-		bool isPrime ( unsigned long pr );
-		unsigned long inverse ( unsigned long y );
+		unsigned long long montMul ( unsigned long long x, unsigned long long y ) const;
+		unsigned long long mulMod ( unsigned long long x, unsigned long long y ) const;
+		unsigned long constantWorkRand ( );
 };
 
+
+/**
+ * Randomly permutes the elements in [first, last) using the Fisher-Yates algorithm.
+ *
+ * Every permutation is equally likely (up to the quality of the generator), since the swap
+ * indices are drawn with randBounded ( ) rather than the rounding rand ( range ).
+ * The swap indices are generated in blocks ahead of the swaps themselves, so the
+ * generator latency overlaps with prefetching the elements about to be swapped.
+ * The result is identical to drawing each index right before its swap.
+ *
+ * If the generator is invalid the range is left unchanged.
+ *
+ * @param first Random access iterator to the first element.
+ * @param last Random access iterator past the last element.
+ */
+template < class RandomIt >
+void ICG :: shuffle ( RandomIt first, RandomIt last ) {
+	typedef typename std :: iterator_traits < RandomIt > :: difference_type diff_t;
+
+	if ( !generatorIsValid ) return;
+
+	const size_t BLOCK = 64;
+	unsigned long idx [ BLOCK ];
+
+	size_t i = ( size_t ) ( last - first );
+	while ( i > 1 ) {
+		// Draw the indices for positions i-1, i-2, ..., i-count.
+		size_t count = ( i - 1 < BLOCK ) ? i - 1 : BLOCK;
+		for ( size_t k = 0; k < count; k++ ) {
+			idx [ k ] = randBounded ( ( unsigned long ) ( i - k ) );
+#if defined ( __GNUC__ )
+			__builtin_prefetch ( &*( first + ( diff_t ) idx [ k ] ), 1 );
+#endif
+		}
+
+		for ( size_t k = 0; k < count; k++ ) {
+			std :: iter_swap ( first + ( diff_t ) ( i - 1 - k ), first + ( diff_t ) idx [ k ] );
+		}
+		i -= count;
+	}
+}
+
+} // namespace ICG_ABI_NAMESPACE
+
+using namespace ICG_ABI_NAMESPACE;
+
 #endif // __ICG_H__
@@ -0,0 +1,301 @@
+#include "ICGCsv.h"
+
+#if __cplusplus >= 201703L
+
+#include "ICG.h"
+#include <errno.h> // using: errno, EINTR
+#include <fcntl.h> // using: open ( )
+#include <math.h> // using: floor ( )
+#include <unistd.h> // using: pwrite ( ), close ( )
+#include <atomic> // using: std::atomic
+#include <charconv> // using: std::to_chars ( )
+#include <memory> // using: std::unique_ptr
+#include <thread> // using: std::thread, std::this_thread::yield ( )
+
+namespace {
+
+/**
+ * Appends the characters produced by to_chars ( first, last, args... ).
+ * Values that do not fit into a small stack buffer (e.g. 1e300 in fixed notation) are formatted in out itself.
+ */
+template < class... Args >
+void appendChars ( std :: string & out, Args... args ) {
+	char buffer [ 64 ];
+	std :: to_chars_result r = std :: to_chars ( buffer, buffer + sizeof ( buffer ), args... );
+	if ( r.ec == std :: errc ( ) ) {
+		out.append ( buffer, r.ptr );
+		return;
+	}
+	for ( size_t room = 1024; ; room *= 4 ) {
+		size_t used = out.size ( );
+		out.resize ( used + room );
+		std :: to_chars_result r = std :: to_chars ( &out [ used ], &out [ 0 ] + out.size ( ), args... );
+		if ( r.ec == std :: errc ( ) ) {
+			out.resize ( r.ptr - &out [ 0 ] );
+			return;
+		}
+		out.resize ( used );
+	}
+}
+
+/**
+ * pwrite ( ) of a whole buffer, continuing after partial writes.
+ */
+bool pwriteAll ( int fd, const char * data, size_t bytes, unsigned long long offset ) {
+	while ( bytes > 0 ) {
+		ssize_t written = pwrite ( fd, data, bytes, ( off_t ) offset );
+		if ( written < 0 ) {
+			if ( errno == EINTR ) continue;
+			return false;
+		}
+		data += written;
+		bytes -= written;
+		offset += written;
+	}
+	return true;
+}
+
+} // namespace
+
+
+/**
+ * Creates a dataset description without columns.
+ *
+ * @param p The generator's prime.
+ * @param a The generator's parameter a.
+ * @param b The generator's parameter b.
+ * @param seed The generator's seed.
+ */
+ICGCsv :: ICGCsv ( unsigned long p, unsigned long a, unsigned long b, unsigned long seed )
+: p ( p ), a ( a ), b ( b ), seed ( seed ), chunkRows ( DEFAULT_CHUNK_ROWS )
+{
+}
+
+
+/**
+ * Adds a column holding the row number, 0, 1, 2, ...
+ *
+ * @param name The column name for the header line.
+ */
+void ICGCsv :: addId ( const std :: string & name ) {
+	Column c = { name, ID, 0, 0, 0.0, 0.0, 0, { } };
+	cols.push_back ( c );
+}
+
+
+/**
+ * Adds a column of integers uniformly distributed in lo, lo+1, ..., hi.
+ *
+ * @param name The column name for the header line.
+ * @param lo The smallest value.
+ * @param hi The largest value.
+ * @return False if hi < lo or the range has 2^32 or more values; no column is added then.
+ */
+bool ICGCsv :: addUniformInt ( const std :: string & name, long long lo, long long hi ) {
+	if ( hi < lo || ( unsigned long long ) hi - ( unsigned long long ) lo >= 0xFFFFFFFFULL ) return false;
+	Column c = { name, UNIFORM_INT, lo, hi, 0.0, 0.0, 0, { } };
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Adds a column of reals uniformly distributed in [ lo, hi ).
+ *
+ * The values are rounded down to the precision, so the written values stay below hi; lo and hi should
+ * be multiples of 10^-precision, since a lo off that grid can be rounded down below lo.
+ *
+ * @param name The column name for the header line.
+ * @param lo The lower bound.
+ * @param hi The upper bound.
+ * @param precision The number of digits after the decimal point, 0 to 17.
+ * @return False if hi < lo or the precision is out of range; no column is added then.
+ */
+bool ICGCsv :: addUniformReal ( const std :: string & name, double lo, double hi, int precision ) {
+	if ( !( lo <= hi ) || precision < 0 || precision > 17 ) return false;
+	Column c = { name, UNIFORM_REAL, 0, 0, lo, hi, precision, { } };
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Adds a column of normally distributed reals.
+ *
+ * @param name The column name for the header line.
+ * @param mu The mean.
+ * @param sigma The standard deviation.
+ * @param precision The number of digits after the decimal point, 0 to 17.
+ * @return False if sigma < 0 or the precision is out of range; no column is added then.
+ */
+bool ICGCsv :: addNormal ( const std :: string & name, double mu, double sigma, int precision ) {
+	if ( !( sigma >= 0.0 ) || precision < 0 || precision > 17 ) return false;
+	Column c = { name, NORMAL, 0, 0, mu, sigma, precision, { } };
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Adds a column of categories, each picked with equal probability.
+ *
+ * The categories are written as given, so they should not contain commas, quotes or line breaks.
+ *
+ * @param name The column name for the header line.
+ * @param categories The possible values.
+ * @return False if the list is empty; no column is added then.
+ */
+bool ICGCsv :: addCategory ( const std :: string & name, const std :: vector < std :: string > & categories ) {
+	if ( categories.empty ( ) ) return false;
+	Column c = { name, CATEGORY, 0, 0, 0.0, 0.0, 0, categories };
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Returns the header line with the column names.
+ *
+ * Private helper method.
+ */
+std :: string ICGCsv :: headerLine ( ) const {
+	std :: string line;
+	for ( size_t c = 0; c < cols.size ( ); c++ ) {
+		if ( c ) line += ',';
+		line += cols [ c ].name;
+	}
+	line += '\n';
+	return line;
+}
+
+
+/**
+ * Formats one chunk of the dataset.
+ *
+ * The values of the chunk are generated column by column from the chunk's substream and then formatted
+ * row by row. Exposed so callers can stream chunks to other sinks than a file.
+ *
+ * @param chunk The chunk number; it covers the rows chunk * chunkRows, ... of the dataset.
+ * @param rows The total number of rows of the dataset, which determines the number of chunks.
+ * @param out Receives the lines of the chunk; its previous content is discarded, its capacity reused.
+ */
+void ICGCsv :: formatChunk ( unsigned long long chunk, unsigned long long rows, std :: string & out ) const {
+	out.clear ( );
+	unsigned long long chunks = ( rows + chunkRows - 1 ) / chunkRows;
+	if ( chunk >= chunks ) return;
+
+	unsigned long long first = chunk * chunkRows;
+	size_t n = ( size_t ) ( ( rows - first < chunkRows ) ? rows - first : chunkRows );
+
+	ICG gen ( p, a, b, seed );
+	gen.jump ( chunk * ( p / chunks ) );
+
+	// column-major generation: one tight loop per column
+	std :: vector < std :: vector < double > > reals ( cols.size ( ) );
+	std :: vector < std :: vector < unsigned long > > ints ( cols.size ( ) );
+	for ( size_t c = 0; c < cols.size ( ); c++ ) {
+		const Column & col = cols [ c ];
+		if ( col.type == UNIFORM_REAL ) {
+			reals [ c ].resize ( n );
+			gen.fill01 ( reals [ c ].data ( ), n );
+			// Fixed formatting rounds to nearest and could print hi, so the values are rounded down to the
+			// precision; a value landing on hi through the rounding of v * scale is moved one step down.
+			double scale = 1.0;
+			for ( int d = 0; d < col.precision; d++ ) scale *= 10.0;
+			for ( size_t r = 0; r < n; r++ ) {
+				double k = floor ( ( col.x + ( col.y - col.x ) * reals [ c ] [ r ] ) * scale );
+				if ( k / scale >= col.y && col.x < col.y ) k -= 1.0;
+				reals [ c ] [ r ] = k / scale;
+			}
+		} else if ( col.type == NORMAL ) {
+			reals [ c ].resize ( n );
+			for ( size_t r = 0; r < n; r++ ) reals [ c ] [ r ] = col.x + col.y * gen.randStdNorm ( );
+		} else if ( col.type == UNIFORM_INT ) {
+			ints [ c ].resize ( n );
+			unsigned long range = ( unsigned long ) ( ( unsigned long long ) col.hi - ( unsigned long long ) col.lo ) + 1;
+			for ( size_t r = 0; r < n; r++ ) ints [ c ] [ r ] = gen.randBounded ( range );
+		} else if ( col.type == CATEGORY ) {
+			ints [ c ].resize ( n );
+			for ( size_t r = 0; r < n; r++ ) ints [ c ] [ r ] = gen.randBounded ( ( unsigned long ) col.categories.size ( ) );
+		}
+	}
+
+	for ( size_t r = 0; r < n; r++ ) {
+		for ( size_t c = 0; c < cols.size ( ); c++ ) {
+			const Column & col = cols [ c ];
+			if ( c ) out.push_back ( ',' );
+			switch ( col.type ) {
+				case ID:
+					appendChars ( out, first + r );
+					break;
+				case UNIFORM_INT:
+					appendChars ( out, ( long long ) ( ( unsigned long long ) col.lo + ints [ c ] [ r ] ) );
+					break;
+				case UNIFORM_REAL:
+				case NORMAL:
+					appendChars ( out, reals [ c ] [ r ], std :: chars_format :: fixed, col.precision );
+					break;
+				case CATEGORY:
+					out += col.categories [ ints [ c ] [ r ] ];
+					break;
+			}
+		}
+		out.push_back ( '\n' );
+	}
+}
+
+
+/**
+ * Generates the dataset into a file.
+ *
+ * The threads take chunks in increasing order. A chunk's offset is the end of the previous chunk,
+ * published by its thread once formatted; the chunk is then written with pwrite ( ) at that offset,
+ * independently of the writes of other chunks.
+ *
+ * @param path The file to write, created or truncated.
+ * @param rows The number of data rows; a header line with the column names precedes them.
+ * @param threads The number of threads, 0 for one per hardware thread.
+ * @return True iff the file has been written. False for an invalid generator, no columns or I/O errors.
+ */
+bool ICGCsv :: write ( const char * path, unsigned long long rows, unsigned threads ) const {
+	if ( cols.empty ( ) || !ICG ( p, a, b, seed ).isValid ( ) ) return false;
+	if ( threads == 0 ) threads = std :: thread :: hardware_concurrency ( );
+	if ( threads == 0 ) threads = 1;
+
+	int fd = open ( path, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if ( fd < 0 ) return false;
+
+	const std :: string header = headerLine ( );
+	const unsigned long long chunks = ( rows + chunkRows - 1 ) / chunkRows;
+
+	// starts [ k ] is the file offset of chunk k, or -1 while chunk k-1 has not been formatted
+	std :: unique_ptr < std :: atomic < long long > [ ] > starts ( new std :: atomic < long long > [ chunks + 1 ] );
+	starts [ 0 ] = ( long long ) header.size ( );
+	for ( unsigned long long k = 1; k <= chunks; k++ ) starts [ k ] = -1;
+
+	std :: atomic < unsigned long long > nextChunk ( 0 );
+	std :: atomic < bool > ok ( pwriteAll ( fd, header.data ( ), header.size ( ), 0 ) );
+	std :: vector < std :: thread > workers;
+
+	for ( unsigned t = 0; t < threads; t++ ) {
+		workers.push_back ( std :: thread ( [ & ] ( ) {
+			std :: string buffer;
+			for ( unsigned long long k; ( k = nextChunk++ ) < chunks; ) {
+				formatChunk ( k, rows, buffer );
+
+				// the previous chunk was taken earlier and is being formatted, so this wait is short
+				long long offset;
+				while ( ( offset = starts [ k ].load ( std :: memory_order_acquire ) ) < 0 ) std :: this_thread :: yield ( );
+				starts [ k + 1 ].store ( offset + ( long long ) buffer.size ( ), std :: memory_order_release );
+
+				if ( !pwriteAll ( fd, buffer.data ( ), buffer.size ( ), ( unsigned long long ) offset ) ) ok = false;
+			}
+		} ) );
+	}
+	for ( unsigned t = 0; t < threads; t++ ) workers [ t ].join ( );
+
+	if ( close ( fd ) != 0 ) ok = false;
+	return ok;
+}
+
+#endif // __cplusplus >= 201703L
@@ -0,0 +1,93 @@
+#ifndef __ICGCSV_H__
+#define __ICGCSV_H__
+
+#if __cplusplus >= 201703L
+
+#include <stddef.h> // using: size_t
+#include <string> // using: std::string
+#include <vector> // using: std::vector
+
+/**
+ * Synthetic CSV datasets generated with all cores.
+ *
+ * A dataset is described by its columns (row IDs, uniform integers, uniform reals, normals and uniform
+ * picks from a list of categories) and written with write ( ). The rows are cut into chunks of
+ * chunkRows rows. Each chunk draws its values from its own ICG substream, column by column, and is
+ * formatted with std :: to_chars into a buffer of the thread that took it. As soon as the size of the
+ * previous chunk is known, a chunk's file offset is fixed and the thread writes it with pwrite ( ), so
+ * the threads never wait for each other's I/O.
+ *
+ * Chunk k uses the generator sequence from ICG :: jump ( k * ( p / chunks ) ), so the file only depends
+ * on the columns, the generator parameters, the number of rows and chunkRows, not on the number of
+ * threads.
+ *
+ * Requires C++17 (std :: to_chars) and POSIX pwrite ( ).
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGCsv.h"
+ *
+ * 	...
+ *
+ * 	ICGCsv csv ( 2147483647, 16807, 1, 12345 );
+ * 	csv.addId ( "id" );
+ * 	csv.addUniformInt ( "age", 18, 90 );
+ * 	csv.addNormal ( "score", 100.0, 15.0, 2 );
+ * 	csv.addCategory ( "color", { "red", "green", "blue" } );
+ * 	csv.write ( "people.csv", 100000000ULL );
+ *
+ */
+class ICGCsv {
+	public:
+		enum ColumnType { ID, UNIFORM_INT, UNIFORM_REAL, NORMAL, CATEGORY };
+
+		struct Column {
+			std :: string name;
+			ColumnType type;
+			long long lo, hi;		// UNIFORM_INT: inclusive bounds
+			double x, y;			// UNIFORM_REAL: interval [ x, y ); NORMAL: mean x, standard deviation y
+			int precision;			// digits after the decimal point for UNIFORM_REAL and NORMAL
+			std :: vector < std :: string > categories;
+		};
+
+		static const size_t DEFAULT_CHUNK_ROWS = 65536;
+
+		ICGCsv ( unsigned long p, unsigned long a, unsigned long b, unsigned long seed );
+
+		void addId ( const std :: string & name );
+		bool addUniformInt ( const std :: string & name, long long lo, long long hi );
+		bool addUniformReal ( const std :: string & name, double lo, double hi, int precision = 6 );
+		bool addNormal ( const std :: string & name, double mu, double sigma, int precision = 6 );
+		bool addCategory ( const std :: string & name, const std :: vector < std :: string > & categories );
+
+		/**
+		 * Returns the columns added so far.
+		 *
+		 * @return The columns in output order.
+		 */
+		const std :: vector < Column > & columns ( ) const { return cols; }
+
+		/**
+		 * Sets the number of rows per chunk, the unit of work of a thread and of one pwrite ( ).
+		 *
+		 * @param rows Rows per chunk, at least 1.
+		 */
+		void setChunkRows ( size_t rows ) { chunkRows = rows ? rows : 1; }
+
+		bool write ( const char * path, unsigned long long rows, unsigned threads = 0 ) const;
+
+		void formatChunk ( unsigned long long chunk, unsigned long long rows, std :: string & out ) const;
+
+	private:
+		unsigned long p, a, b, seed;
+		std :: vector < Column > cols;
+		size_t chunkRows;
+
+		std :: string headerLine ( ) const;
+};
+
+#endif // __cplusplus >= 201703L
+
+#endif /* __ICGCSV_H__ */
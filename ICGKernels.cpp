@@ -0,0 +1,450 @@
+#include "ICGKernels.h"
+#include <stdlib.h> // using: getenv ( )
+#include <string.h> // using: strcmp ( )
+#include <atomic> // using: std::atomic
+
+// The SIMD variants assume 64 bit unsigned long and the GCC / Clang target attribute.
+#if defined ( __GNUC__ ) && defined ( __x86_64__ ) && defined ( __LP64__ )
+#define ICG_KERNELS_X86
+#include <cpuid.h> // using: __get_cpuid ( ), __get_cpuid_max ( ), __cpuid_count ( )
+#include <immintrin.h> // using: SSE4.2, AVX2, AVX-512F and AVX-512 IFMA intrinsics
+#endif
+
+namespace {
+
+unsigned long long mulMod ( unsigned long long x, unsigned long long y, unsigned long long p ) {
+#if defined ( __SIZEOF_INT128__ )
+	if ( p > 0xFFFFFFFFULL ) return ( unsigned long long ) ( ( unsigned __int128 ) x * y % p );
+#endif
+	return x * y % p;
+}
+
+/**
+ * Inverse of y modulo p by the extended Euclidean algorithm, as in ICG :: inverse ( ).
+ */
+unsigned long long inverseMod ( unsigned long long y, unsigned long long p ) {
+	if ( y == 0 || y >= p ) return 0;
+
+	unsigned long long rn = p, rn1 = y;
+	long long Rn2 = 0, Rn1 = 1;
+	while ( rn1 != 0 ) {
+		unsigned long long q = rn / rn1, r = rn % rn1;
+		long long Rn = Rn2 - ( long long ) q * Rn1;
+		rn = rn1;
+		rn1 = r;
+		Rn2 = Rn1;
+		Rn1 = Rn;
+	}
+	// rn is the gcd 1 and Rn2 its coefficient of y
+	return ( unsigned long long ) ( Rn2 < 0 ? Rn2 + ( long long ) p : Rn2 );
+}
+
+
+void toUnitScalar ( const unsigned long * x, double * out, size_t n, unsigned long p ) {
+	for ( size_t i = 0; i < n; i++ ) out [ i ] = ( double ) x [ i ] / ( double ) p;
+}
+
+/**
+ * Batch inversion with Montgomery's trick: the inverse of the product of all values, multiplied with
+ * the prefix products, gives every single inverse. Values without an inverse (0 and values >= p) give 0.
+ * The prefix products are kept in out, so x and out must not overlap.
+ */
+void inverseScalar ( const unsigned long * x, unsigned long * out, size_t n, unsigned long p ) {
+	unsigned long long prefix = 1;
+	for ( size_t i = 0; i < n; i++ ) {
+		if ( x [ i ] != 0 && x [ i ] < p ) prefix = mulMod ( prefix, x [ i ], p );
+		out [ i ] = ( unsigned long ) prefix;
+	}
+
+	unsigned long long inv = inverseMod ( prefix, p );
+	for ( size_t i = n; i-- > 0; ) {
+		if ( x [ i ] == 0 || x [ i ] >= p ) {
+			out [ i ] = 0;
+			continue;
+		}
+		// inv is the inverse of the prefix product up to i
+		out [ i ] = ( unsigned long ) mulMod ( inv, i > 0 ? out [ i - 1 ] : 1, p );
+		inv = mulMod ( inv, x [ i ], p );
+	}
+}
+
+/**
+ * ICG steps of all lanes, with one batch inversion per step. A state 0 has the inverse 0 and is
+ * followed by b, as in ICG :: rand ( ).
+ */
+void stepScalar ( unsigned long * states, size_t lanes, unsigned long * out, size_t steps,
+				  unsigned long p, unsigned long a, unsigned long b ) {
+	for ( size_t s = 0; s < steps; s++ ) {
+		unsigned long * row = out + s * lanes;
+		inverseScalar ( states, row, lanes, p );
+		for ( size_t l = 0; l < lanes; l++ ) row [ l ] = states [ l ] = ( unsigned long ) ( ( mulMod ( a, row [ l ], p ) + b ) % p );
+	}
+}
+
+
+#if defined ( ICG_KERNELS_X86 )
+
+// Exact conversion of 64 bit integers to double without AVX-512DQ: the low and the high 32 bits are
+// placed into the mantissas of 2^52 and 2^84, the offsets are subtracted exactly, and the final
+// addition rounds once, like the scalar conversion.
+const long long EXP52 = 0x4330000000000000LL;
+const long long EXP84 = 0x4530000000000000LL;
+const double OFFSET = 19342813118337666422669312.0;	// 2^84 + 2^52
+
+__attribute__ ( ( target ( "sse4.2" ) ) )
+void toUnitSse42 ( const unsigned long * x, double * out, size_t n, unsigned long p ) {
+	const __m128d denominator = _mm_set1_pd ( ( double ) p );
+	const __m128i lowExp = _mm_set1_epi64x ( EXP52 ), highExp = _mm_set1_epi64x ( EXP84 );
+	const __m128d offset = _mm_set1_pd ( OFFSET );
+
+	size_t i = 0;
+	for ( ; i + 2 <= n; i += 2 ) {
+		__m128i v = _mm_loadu_si128 ( ( const __m128i * ) ( x + i ) );
+		__m128i low = _mm_blend_epi16 ( v, lowExp, 0xCC );
+		__m128i high = _mm_or_si128 ( _mm_srli_epi64 ( v, 32 ), highExp );
+		__m128d d = _mm_add_pd ( _mm_sub_pd ( _mm_castsi128_pd ( high ), offset ), _mm_castsi128_pd ( low ) );
+		_mm_storeu_pd ( out + i, _mm_div_pd ( d, denominator ) );
+	}
+	toUnitScalar ( x + i, out + i, n - i, p );
+}
+
+__attribute__ ( ( target ( "avx2" ) ) )
+void toUnitAvx2 ( const unsigned long * x, double * out, size_t n, unsigned long p ) {
+	const __m256d denominator = _mm256_set1_pd ( ( double ) p );
+	const __m256i lowExp = _mm256_set1_epi64x ( EXP52 ), highExp = _mm256_set1_epi64x ( EXP84 );
+	const __m256d offset = _mm256_set1_pd ( OFFSET );
+
+	size_t i = 0;
+	for ( ; i + 4 <= n; i += 4 ) {
+		__m256i v = _mm256_loadu_si256 ( ( const __m256i * ) ( x + i ) );
+		__m256i low = _mm256_blend_epi32 ( v, lowExp, 0xAA );
+		__m256i high = _mm256_or_si256 ( _mm256_srli_epi64 ( v, 32 ), highExp );
+		__m256d d = _mm256_add_pd ( _mm256_sub_pd ( _mm256_castsi256_pd ( high ), offset ), _mm256_castsi256_pd ( low ) );
+		_mm256_storeu_pd ( out + i, _mm256_div_pd ( d, denominator ) );
+	}
+	toUnitScalar ( x + i, out + i, n - i, p );
+}
+
+// Montgomery arithmetic modulo an odd p < 2^52 with R = 2^52 in the eight lanes of a vector.
+// vpmadd52luq / vpmadd52huq add the low / high 52 bits of the 104 bit products of 52 bit lanes.
+struct Mont52 {
+	__m512i p;
+	__m512i pInv;	// -p^-1 mod 2^52
+	__m512i one;	// R mod p, 1 in Montgomery form
+	__m512i r2;		// R^2 mod p, the factor converting into Montgomery form
+	__m512i a, b;	// the generator parameters
+};
+
+/**
+ * Reduces lanes x < 2p modulo p.
+ */
+__attribute__ ( ( target ( "avx512f" ), always_inline ) ) inline
+__m512i reduceOnce ( __m512i x, __m512i p ) {
+	return _mm512_mask_sub_epi64 ( x, _mm512_cmpge_epu64_mask ( x, p ), x, p );
+}
+
+/**
+ * Montgomery product x * y / R mod p of lanes x, y < p.
+ */
+__attribute__ ( ( target ( "avx512f,avx512ifma" ), always_inline ) ) inline
+__m512i montMul52 ( __m512i x, __m512i y, const Mont52 & m ) {
+	const __m512i zero = _mm512_setzero_si512 ( );
+	__m512i lo = _mm512_madd52lo_epu64 ( zero, x, y );
+	__m512i hi = _mm512_madd52hi_epu64 ( zero, x, y );
+	__m512i q = _mm512_madd52lo_epu64 ( zero, lo, m.pInv );
+	// ( x * y + q * p ) / R = hi + high half of q * p + carry, where lo + low half of q * p is R unless lo = 0
+	__m512i t = _mm512_madd52hi_epu64 ( hi, q, m.p );
+	t = _mm512_mask_add_epi64 ( t, _mm512_test_epi64_mask ( lo, lo ), t, _mm512_set1_epi64 ( 1 ) );
+	// t < ( p^2 + R p ) / R < 2p
+	return reduceOnce ( t, m.p );
+}
+
+/**
+ * Advances count <= 64 * G lanes, whose outputs are stored with the given stride in out.
+ *
+ * Each group of up to 64 lanes (eight vectors) is inverted with Montgomery's trick, with the vectors
+ * as the elements: the prefix products of the vectors are computed lane by lane, the last one is
+ * inverted by Fermat's little theorem, x^-1 = x^(p-2), and multiplied back down the prefixes. The
+ * G groups are processed together to hide the latency of the dependent multiplications.
+ */
+template < int G >
+__attribute__ ( ( target ( "avx512f,avx512ifma" ) ) )
+void stepIfmaBlock ( unsigned long * states, size_t count, unsigned long * out, size_t stride, size_t steps,
+					 const Mont52 & m, unsigned long long e, int top ) {
+	const int V = 8;
+	const int vectors = ( G == 1 ) ? ( int ) ( ( count + 7 ) / 8 ) : V;
+
+	__mmask8 mask [ G ] [ V ];
+	__m512i cur [ G ] [ V ];
+	for ( int g = 0; g < G; g++ ) {
+		for ( int v = 0; v < vectors; v++ ) {
+			size_t first = 8 * ( size_t ) ( g * V + v );
+			size_t left = ( first < count ) ? count - first : 0;
+			mask [ g ] [ v ] = ( left >= 8 ) ? ( __mmask8 ) 0xFF : ( __mmask8 ) ( ( 1u << left ) - 1 );
+			cur [ g ] [ v ] = _mm512_maskz_loadu_epi64 ( mask [ g ] [ v ], states + first );
+		}
+	}
+
+	for ( size_t s = 0; s < steps; s++ ) {
+		// Montgomery forms, with 1 for the lanes in state 0 (which have no inverse), and their prefix products
+		__m512i x [ G ] [ V ], prefix [ G ] [ V ];
+		__mmask8 nonzero [ G ] [ V ];
+		for ( int v = 0; v < vectors; v++ ) {
+			for ( int g = 0; g < G; g++ ) {
+				nonzero [ g ] [ v ] = _mm512_test_epi64_mask ( cur [ g ] [ v ], cur [ g ] [ v ] );
+				x [ g ] [ v ] = _mm512_mask_mov_epi64 ( m.one, nonzero [ g ] [ v ], montMul52 ( cur [ g ] [ v ], m.r2, m ) );
+				prefix [ g ] [ v ] = v ? montMul52 ( prefix [ g ] [ v - 1 ], x [ g ] [ v ], m ) : x [ g ] [ v ];
+			}
+		}
+
+		// inverse of the full products, left-to-right square-and-multiply
+		__m512i inv [ G ];
+		for ( int g = 0; g < G; g++ ) inv [ g ] = prefix [ g ] [ vectors - 1 ];
+		for ( int bit = top - 1; bit >= 0; bit-- ) {
+			for ( int g = 0; g < G; g++ ) inv [ g ] = montMul52 ( inv [ g ], inv [ g ], m );
+			if ( ( e >> bit ) & 1 ) {
+				for ( int g = 0; g < G; g++ ) inv [ g ] = montMul52 ( inv [ g ], prefix [ g ] [ vectors - 1 ], m );
+			}
+		}
+
+		for ( int v = vectors - 1; v >= 0; v-- ) {
+			for ( int g = 0; g < G; g++ ) {
+				// inv is the inverse of prefix [ v ], so times prefix [ v - 1 ] it is the inverse of x [ v ]
+				__m512i xInv = inv [ g ];
+				if ( v ) {
+					xInv = montMul52 ( inv [ g ], prefix [ g ] [ v - 1 ], m );
+					inv [ g ] = montMul52 ( inv [ g ], x [ g ] [ v ], m );
+				}
+				// the Montgomery product with a leaves a * inverse ( cur ) in normal form; state 0 gives b
+				__m512i next = _mm512_maskz_mov_epi64 ( nonzero [ g ] [ v ], montMul52 ( xInv, m.a, m ) );
+				cur [ g ] [ v ] = reduceOnce ( _mm512_add_epi64 ( next, m.b ), m.p );
+				_mm512_mask_storeu_epi64 ( out + s * stride + 8 * ( g * V + v ), mask [ g ] [ v ], cur [ g ] [ v ] );
+			}
+		}
+	}
+
+	for ( int g = 0; g < G; g++ ) {
+		for ( int v = 0; v < vectors; v++ ) _mm512_mask_storeu_epi64 ( states + 8 * ( g * V + v ), mask [ g ] [ v ], cur [ g ] [ v ] );
+	}
+}
+
+__attribute__ ( ( target ( "avx512f,avx512ifma" ) ) )
+void stepIfma ( unsigned long * states, size_t lanes, unsigned long * out, size_t steps,
+				unsigned long p, unsigned long a, unsigned long b ) {
+	// below 24 lanes one Fermat exponentiation per step costs more than the extended Euclidean algorithm
+	if ( lanes < 24 || p < 3 || p >= ( 1ULL << 52 ) || !( p & 1 ) ) {
+		stepScalar ( states, lanes, out, steps, p, a, b );
+		return;
+	}
+
+	// Newton iteration for p^-1 mod 2^64, each step doubles the number of correct bits
+	unsigned long long inv = p;
+	for ( int i = 0; i < 5; i++ ) inv *= 2 - p * inv;
+	unsigned long long r = ( 1ULL << 52 ) % p;
+
+	Mont52 m;
+	m.p = _mm512_set1_epi64 ( ( long long ) p );
+	m.pInv = _mm512_set1_epi64 ( ( long long ) ( ( 0 - inv ) & ( ( 1ULL << 52 ) - 1 ) ) );
+	m.one = _mm512_set1_epi64 ( ( long long ) r );
+	m.r2 = _mm512_set1_epi64 ( ( long long ) mulMod ( r, r, p ) );
+	m.a = _mm512_set1_epi64 ( ( long long ) a );
+	m.b = _mm512_set1_epi64 ( ( long long ) b );
+
+	const unsigned long long e = p - 2;
+	const int top = 63 - __builtin_clzll ( e );
+
+	size_t l = 0;
+	for ( ; l + 256 <= lanes; l += 256 ) stepIfmaBlock < 4 > ( states + l, 256, out + l, lanes, steps, m, e, top );
+	for ( ; l < lanes; l += 64 ) stepIfmaBlock < 1 > ( states + l, lanes - l < 64 ? lanes - l : 64, out + l, lanes, steps, m, e, top );
+}
+
+unsigned long long xgetbv0 ( ) {
+	unsigned eax, edx;
+	__asm__ ( "xgetbv" : "=a" ( eax ), "=d" ( edx ) : "c" ( 0 ) );
+	return ( ( unsigned long long ) edx << 32 ) | eax;
+}
+
+#endif
+
+
+struct KernelTable {
+	ICGKernels :: Level level;
+	void ( * toUnit ) ( const unsigned long *, double *, size_t, unsigned long );
+	void ( * inverse ) ( const unsigned long *, unsigned long *, size_t, unsigned long );
+	void ( * step ) ( unsigned long *, size_t, unsigned long *, size_t, unsigned long, unsigned long, unsigned long );
+};
+
+// One entry per level; detected ( ) never returns a level whose entry uses unavailable instructions.
+// toUnit is bound by the divider, which is not faster per value with 512 bit vectors, so AVX-512 uses AVX2.
+const KernelTable TABLES [ ] = {
+	{ ICGKernels :: SCALAR, toUnitScalar, inverseScalar, stepScalar },
+#if defined ( ICG_KERNELS_X86 )
+	{ ICGKernels :: SSE42, toUnitSse42, inverseScalar, stepScalar },
+	{ ICGKernels :: AVX2, toUnitAvx2, inverseScalar, stepScalar },
+	{ ICGKernels :: AVX512, toUnitAvx2, inverseScalar, stepScalar },
+	{ ICGKernels :: AVX512IFMA, toUnitAvx2, inverseScalar, stepIfma }
+#else
+	{ ICGKernels :: SSE42, toUnitScalar, inverseScalar, stepScalar },
+	{ ICGKernels :: AVX2, toUnitScalar, inverseScalar, stepScalar },
+	{ ICGKernels :: AVX512, toUnitScalar, inverseScalar, stepScalar },
+	{ ICGKernels :: AVX512IFMA, toUnitScalar, inverseScalar, stepScalar }
+#endif
+};
+
+std :: atomic < const KernelTable * > current ( 0 );
+
+ICGKernels :: Level detectLevel ( ) {
+#if defined ( ICG_KERNELS_X86 )
+	unsigned eax, ebx, ecx, edx;
+	if ( !__get_cpuid ( 1, &eax, &ebx, &ecx, &edx ) || !( ecx & bit_SSE4_2 ) ) return ICGKernels :: SCALAR;
+
+	// AVX needs the operating system to save the YMM state (XCR0 bits 1 and 2)
+	if ( !( ecx & bit_OSXSAVE ) || !( ecx & bit_AVX ) ) return ICGKernels :: SSE42;
+	unsigned long long xcr0 = xgetbv0 ( );
+	if ( ( xcr0 & 0x06 ) != 0x06 || __get_cpuid_max ( 0, 0 ) < 7 ) return ICGKernels :: SSE42;
+
+	__cpuid_count ( 7, 0, eax, ebx, ecx, edx );
+	if ( !( ebx & bit_AVX2 ) ) return ICGKernels :: SSE42;
+
+	// AVX-512 additionally needs the opmask and ZMM state (XCR0 bits 5, 6 and 7)
+	if ( !( ebx & bit_AVX512F ) || ( xcr0 & 0xE0 ) != 0xE0 ) return ICGKernels :: AVX2;
+	if ( !( ebx & bit_AVX512IFMA ) ) return ICGKernels :: AVX512;
+	return ICGKernels :: AVX512IFMA;
+#else
+	return ICGKernels :: SCALAR;
+#endif
+}
+
+/**
+ * The detected level, or the level requested by ICG_KERNELS if that is lower.
+ */
+ICGKernels :: Level initialLevel ( ) {
+	ICGKernels :: Level level = ICGKernels :: detected ( );
+	const char * requested = getenv ( "ICG_KERNELS" );
+	if ( requested ) {
+		for ( int l = ICGKernels :: SCALAR; l <= ICGKernels :: AVX512IFMA; l++ ) {
+			if ( strcmp ( requested, ICGKernels :: name ( ( ICGKernels :: Level ) l ) ) == 0 && l < level ) {
+				level = ( ICGKernels :: Level ) l;
+			}
+		}
+	}
+	return level;
+}
+
+const KernelTable & table ( ) {
+	const KernelTable * t = current.load ( std :: memory_order_acquire );
+	if ( !t ) {
+		// concurrent first calls all store the same entry
+		t = &TABLES [ initialLevel ( ) ];
+		current.store ( t, std :: memory_order_release );
+	}
+	return *t;
+}
+
+} // namespace
+
+
+/**
+ * Returns the best level supported by the CPU and the operating system.
+ *
+ * @return The detected level; SCALAR on other architectures than x86-64.
+ */
+ICGKernels :: Level ICGKernels :: detected ( ) {
+	static const Level level = detectLevel ( );
+	return level;
+}
+
+
+/**
+ * Returns the level whose kernels are called.
+ *
+ * @return The detected level, unless lowered by ICG_KERNELS or select ( ).
+ */
+ICGKernels :: Level ICGKernels :: active ( ) {
+	return table ( ).level;
+}
+
+
+/**
+ * Selects the level whose kernels are called from now on, e.g. to compare the variants in tests
+ * and benchmarks. Must not be called while other threads use the kernels.
+ *
+ * @param level The requested level.
+ * @return The level actually selected: the requested one, or the detected one if that is lower.
+ */
+ICGKernels :: Level ICGKernels :: select ( Level level ) {
+	if ( level > detected ( ) ) level = detected ( );
+	if ( level < SCALAR ) level = SCALAR;
+	current.store ( &TABLES [ level ], std :: memory_order_release );
+	return level;
+}
+
+
+/**
+ * Returns the name of a level, as accepted by the environment variable ICG_KERNELS.
+ *
+ * @param level A level.
+ * @return "scalar", "sse4.2", "avx2", "avx512" or "avx512ifma".
+ */
+const char * ICGKernels :: name ( Level level ) {
+	switch ( level ) {
+		case SSE42: return "sse4.2";
+		case AVX2: return "avx2";
+		case AVX512: return "avx512";
+		case AVX512IFMA: return "avx512ifma";
+		default: return "scalar";
+	}
+}
+
+
+/**
+ * Converts raw generator outputs to doubles in [0,1).
+ *
+ * The values are bit-identical to those of ICG :: rand01 ( ) for the same outputs.
+ *
+ * @param x Outputs of ICG :: rand ( ), each < p.
+ * @param out Buffer receiving x [ i ] / p.
+ * @param n The number of values.
+ * @param p The prime modulus of the generator, < 2^63.
+ */
+void ICGKernels :: toUnit ( const unsigned long * x, double * out, size_t n, unsigned long p ) {
+	table ( ).toUnit ( x, out, n, p );
+}
+
+
+/**
+ * Computes the modular inverses of a batch of values.
+ *
+ * out [ i ] equals ICG :: inverse ( x [ i ] ) of a generator with modulus p: the inverse modulo p,
+ * or 0 for 0 and for values >= p.
+ *
+ * @param x The values.
+ * @param out Buffer receiving the inverses; must not overlap x.
+ * @param n The number of values.
+ * @param p A prime modulus < 2^63.
+ */
+void ICGKernels :: inverse ( const unsigned long * x, unsigned long * out, size_t n, unsigned long p ) {
+	table ( ).inverse ( x, out, n, p );
+}
+
+
+/**
+ * Advances independent ICG streams with common parameters.
+ *
+ * Lane l is in the same state as a generator ICG ( p, a, b, seed ) with get_state ( ) == states [ l ];
+ * its next outputs are written to out [ l ], out [ lanes + l ], out [ 2 * lanes + l ], ..., bit-identical
+ * to the values of ICG :: rand ( ) of that generator, and states [ l ] is updated to the last one.
+ * The AVX-512 IFMA variant needs p < 2^52 and at least 24 lanes, and is fastest from 256 lanes on.
+ *
+ * @param states The states of the lanes, each < p; updated.
+ * @param lanes The number of lanes.
+ * @param out Buffer receiving steps * lanes values.
+ * @param steps The number of steps.
+ * @param p The prime modulus of a valid generator.
+ * @param a The parameter a, < p.
+ * @param b The parameter b, < p.
+ */
+void ICGKernels :: step ( unsigned long * states, size_t lanes, unsigned long * out, size_t steps,
+						  unsigned long p, unsigned long a, unsigned long b ) {
+	table ( ).step ( states, lanes, out, steps, p, a, b );
+}
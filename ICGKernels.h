@@ -0,0 +1,80 @@
+#ifndef __ICGKERNELS_H__
+#define __ICGKERNELS_H__
+
+#include <stddef.h> // using: size_t
+
+/**
+ * Bulk kernels with runtime CPU dispatch.
+ *
+ * A single binary has to run on machines of different CPU generations. Every kernel therefore has a
+ * portable scalar reference implementation and may have variants for SSE4.2, AVX2, AVX-512 and
+ * AVX-512 IFMA (52 bit integer multiply-add, Ice Lake and Zen 4 onwards), which are compiled with
+ * per-function target attributes, so no part of the library needs special compiler flags. On first use
+ * the best level supported by the CPU and the operating system is detected with cpuid (and xgetbv, for
+ * the register state the operating system saves), and from then on the kernels of that level are called.
+ * A kernel without a variant for the selected level uses the next lower one. All variants give
+ * bit-identical results; the level only changes the speed.
+ *
+ * The environment variable ICG_KERNELS forces a level, e.g. ICG_KERNELS=scalar to compare against the
+ * reference on a machine with AVX-512. Its values are scalar, sse4.2, avx2, avx512 and avx512ifma;
+ * a level above the detected one is lowered to it, and other values are ignored. select ( ) does the
+ * same from code.
+ *
+ * Kernels:
+ *
+ *  - toUnit:   x / p as double, the conversion of ICG :: rand01 ( ) and ICG :: fill01 ( ), for a buffer
+ *              of raw outputs.
+ *  - inverse:  modular inverses of a batch with Montgomery's trick, which needs one extended Euclidean
+ *              algorithm for the whole batch and three multiplications per value.
+ *  - step:     advances many ICG streams with common parameters at once, e.g. the substreams of one
+ *              generator, bit-identical to ICG :: rand ( ). The scalar version inverts the states of
+ *              all streams of a step as one batch. With AVX-512 IFMA and p < 2^52, eight streams per
+ *              vector are stepped in Montgomery arithmetic with vpmadd52luq / vpmadd52huq; the batch
+ *              of up to eight vectors is inverted lane by lane with Fermat's little theorem,
+ *              inverse ( x ) = x^(p-2).
+ *
+ * Requires C++11. The variants are compiled for x86-64 with GCC or Clang; elsewhere every level is scalar.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGKernels.h"
+ *
+ * 	...
+ *
+ * 	ICG icg ( 2147483647, 16807, 1, 12345 );
+ * 	std :: vector < unsigned long > raw ( 4096 );
+ * 	std :: vector < double > u ( raw.size ( ) );
+ * 	icg.fill ( &raw [ 0 ], raw.size ( ) );
+ * 	ICGKernels :: toUnit ( &raw [ 0 ], &u [ 0 ], raw.size ( ), icg.get_p ( ) );
+ *
+ * 	printf ( "kernels: %s\n", ICGKernels :: name ( ICGKernels :: active ( ) ) );
+ *
+ * 	// 32 substreams of one generator, advanced together by 1000 steps
+ * 	unsigned long states [ 32 ];
+ * 	for ( int l = 0; l < 32; l++ ) {
+ * 		ICG sub ( 2147483647, 16807, 1, 12345 );
+ * 		sub.jump ( l * ( 2147483647UL / 32 ) );
+ * 		states [ l ] = sub.get_state ( );
+ * 	}
+ * 	std :: vector < unsigned long > out ( 32 * 1000 );		// out [ s * 32 + l ]: step s of substream l
+ * 	ICGKernels :: step ( states, 32, &out [ 0 ], 1000, 2147483647, 16807, 1 );
+ *
+ */
+class ICGKernels {
+	public:
+		enum Level { SCALAR = 0, SSE42 = 1, AVX2 = 2, AVX512 = 3, AVX512IFMA = 4 };
+
+		static Level detected ( );
+		static Level active ( );
+		static Level select ( Level level );
+		static const char * name ( Level level );
+
+		static void toUnit ( const unsigned long * x, double * out, size_t n, unsigned long p );
+		static void inverse ( const unsigned long * x, unsigned long * out, size_t n, unsigned long p );
+		static void step ( unsigned long * states, size_t lanes, unsigned long * out, size_t steps,
+						   unsigned long p, unsigned long a, unsigned long b );
+};
+
+#endif /* __ICGKERNELS_H__ */
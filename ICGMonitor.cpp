@@ -0,0 +1,188 @@
+#include "ICGMonitor.h"
+#include <math.h> // using: exp ( ), fabs ( ), lgamma ( ), log ( ), sqrt ( )
+#include <string.h> // using: memset ( )
+#include <algorithm> // using: std::sort ( )
+
+namespace {
+
+/**
+ * Regularized upper incomplete gamma function Q ( s, x ).
+ */
+double gammaQ ( double s, double x ) {
+	if ( x <= 0.0 ) return 1.0;
+	double lnPrefix = s * log ( x ) - x - lgamma ( s );
+	if ( x < s + 1.0 ) {
+		// series for P ( s, x )
+		double term = 1.0 / s, sum = term;
+		for ( int n = 1; n < 1000000; n++ ) {
+			term *= x / ( s + n );
+			sum += term;
+			if ( term < sum * 1e-15 ) break;
+		}
+		return 1.0 - sum * exp ( lnPrefix );
+	}
+	// continued fraction for Q ( s, x ), modified Lentz
+	double bb = x + 1.0 - s, c = 1e300, d = 1.0 / bb, h = d;
+	for ( int n = 1; n < 1000000; n++ ) {
+		double an = -n * ( n - s );
+		bb += 2.0;
+		d = an * d + bb;
+		if ( fabs ( d ) < 1e-300 ) d = 1e-300;
+		c = bb + an / c;
+		if ( fabs ( c ) < 1e-300 ) c = 1e-300;
+		d = 1.0 / d;
+		double delta = d * c;
+		h *= delta;
+		if ( fabs ( delta - 1.0 ) < 1e-15 ) break;
+	}
+	return exp ( lnPrefix ) * h;
+}
+
+/**
+ * Kolmogorov distribution P ( K > lambda ).
+ */
+double kolmogorovPValue ( double lambda ) {
+	if ( lambda < 0.2 ) return 1.0;
+	double sum = 0.0;
+	for ( int j = 1; j <= 100; j++ ) {
+		double term = exp ( -2.0 * j * j * lambda * lambda );
+		sum += ( j & 1 ) ? term : -term;
+		if ( term < 1e-17 ) break;
+	}
+	return 2.0 * sum;
+}
+
+/**
+ * Two-sided p-value of an observed count y of a Poisson variable with the given mean.
+ */
+double poissonPValue ( double y, double mean ) {
+	double le = gammaQ ( y + 1.0, mean );				// P ( Y <= y )
+	double ge = ( y < 1.0 ) ? 1.0 : 1.0 - gammaQ ( y, mean );	// P ( Y >= y )
+	double p = 2.0 * ( le < ge ? le : ge );
+	return p < 1.0 ? p : 1.0;
+}
+
+} // namespace
+
+
+/**
+ * Creates a monitor for a generator.
+ *
+ * The generator must outlive the monitor. It may be reparametrized or reseeded while being monitored;
+ * the samples are normalized with the parameters current when they are taken.
+ *
+ * @param icg The monitored generator.
+ * @param k One in k outputs is sampled; 0 is taken as 1.
+ * @param window Samples per window, at least 5 * BINS so that every chi-square cell expects 5 samples.
+ * @param alpha Significance level at which a window fails.
+ * @param failLimit Consecutive failed windows which raise the drift flag; 0 is taken as 1.
+ */
+ICGMonitor :: ICGMonitor ( ICG & icg, unsigned k, size_t window, double alpha, unsigned failLimit )
+: icg ( icg ), k ( k ? k : 1 ), countdown ( k ? k : 1 ), alpha ( alpha ), failLimit ( failLimit ? failLimit : 1 ),
+  values ( window < 5 * BINS ? 5 * BINS : window ), previous ( values.size ( ) ), filled ( 0 ), previousSize ( 0 ),
+  consecutiveFailures ( 0 ), failures ( 0 ), drift ( false )
+{
+	memset ( cells, 0, sizeof ( cells ) );
+	memset ( &report, 0, sizeof ( report ) );
+}
+
+
+/**
+ * Writes the next n outputs of ICG :: rand ( ) into a buffer and passes them to the monitor.
+ *
+ * Only the sampled positions of the buffer are read again, so this costs the same as ICG :: fill ( ).
+ *
+ * @param out Buffer receiving n random numbers.
+ * @param n The number of values.
+ */
+void ICGMonitor :: fill ( unsigned long * out, size_t n ) {
+	icg.fill ( out, n );
+
+	size_t i = countdown - 1;
+	for ( ; i < n; i += k ) sample ( out [ i ] );
+	countdown = ( unsigned ) ( i - n + 1 );
+}
+
+
+/**
+ * Adds a sampled output to the current window and tests the window when it is full.
+ *
+ * Outputs outside 0, ..., p-1, which can only come from observe ( ), are taken as 0.
+ *
+ * @param x The sampled output.
+ */
+void ICGMonitor :: sample ( unsigned long x ) {
+	countdown = k;
+
+	unsigned long p = icg.get_p ( );
+	double u = ( x < p ) ? ( double ) x / ( double ) p : 0.0;
+	unsigned cell = ( unsigned ) ( u * BINS );
+	cells [ cell < BINS ? cell : BINS - 1 ]++;
+
+	values [ filled++ ] = u;
+	if ( filled == values.size ( ) ) closeWindow ( );
+}
+
+
+/**
+ * Tests the completed window, updates the report and the drift flag and starts a new window.
+ */
+void ICGMonitor :: closeWindow ( ) {
+	const size_t n = filled;
+	const double dn = ( double ) n;
+
+	double expected = dn / BINS, chi2 = 0.0;
+	for ( unsigned i = 0; i < BINS; i++ ) {
+		double diff = cells [ i ] - expected;
+		chi2 += diff * diff / expected;
+	}
+
+	// the sorted window gives the empirical distribution function for KS and makes repetitions adjacent
+	std :: sort ( values.begin ( ), values.begin ( ) + n );
+	double d = 0.0;
+	unsigned long long repeats = 0;
+	for ( size_t i = 0; i < n; i++ ) {
+		double above = ( i + 1 ) / dn - values [ i ], below = values [ i ] - i / dn;
+		if ( above > d ) d = above;
+		if ( below > d ) d = below;
+		if ( i > 0 && values [ i ] == values [ i - 1 ] ) repeats++;
+	}
+
+	// samples also found in the previous window, by merging the sorted windows
+	for ( size_t i = 0, j = 0; i < n && j < previousSize; ) {
+		if ( values [ i ] < previous [ j ] ) i++;
+		else if ( previous [ j ] < values [ i ] ) j++;
+		else {
+			// equal samples within the window were counted above
+			if ( i == 0 || values [ i ] != values [ i - 1 ] ) repeats++;
+			i++;
+		}
+	}
+
+	// in a random sequence over p values, n samples repeat about n ( n - 1 ) / ( 2 p ) times among
+	// themselves and n m / p times with m earlier samples (Poisson)
+	unsigned long p = icg.get_p ( );
+	double repeatMean = dn * ( dn - 1.0 + 2.0 * previousSize ) / 2.0 / ( double ) ( p ? p : 1 );
+
+	report.window++;
+	report.samples = n;
+	report.chiSquare = chi2;
+	report.chiSquarePValue = gammaQ ( ( BINS - 1 ) / 2.0, chi2 / 2.0 );
+	report.ks = d;
+	report.ksPValue = kolmogorovPValue ( ( sqrt ( dn ) + 0.12 + 0.11 / sqrt ( dn ) ) * d );
+	report.repeats = repeats;
+	report.repeatsPValue = poissonPValue ( ( double ) repeats, repeatMean );
+	report.failed = report.chiSquarePValue < alpha || report.ksPValue < alpha || report.repeatsPValue < alpha;
+
+	if ( report.failed ) {
+		failures++;
+		if ( ++consecutiveFailures >= failLimit ) drift = true;
+	} else {
+		consecutiveFailures = 0;
+	}
+
+	values.swap ( previous );
+	previousSize = n;
+	filled = 0;
+	memset ( cells, 0, sizeof ( cells ) );
+}
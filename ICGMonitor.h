@@ -0,0 +1,149 @@
+#ifndef __ICGMONITOR_H__
+#define __ICGMONITOR_H__
+
+#include "ICG.h"
+#include <stddef.h> // using: size_t
+#include <vector> // using: std::vector
+
+/**
+ * Online quality monitor for generators running in long-lived services.
+ *
+ * The monitor wraps an ICG and inspects one in k of its outputs (by default k = 1024); the other outputs
+ * only cost a decrement and a predictable branch. The sampled values are normalized to [0,1) and
+ * collected in windows of a fixed number of samples. When a window is full it is tested for
+ *
+ *  - uniformity: chi-square test on BINS equal cells, whose counts are updated with every sample;
+ *  - distribution: exact Kolmogorov-Smirnov test of the sorted window against the uniform distribution;
+ *  - repetitions: number of sampled values equal to an earlier sample of the window or of the previous
+ *    window, against the birthday expectation of a random sequence over p values. An excess points to
+ *    a period shorter than two windows; a deficit to a sequence of few values cycling in order.
+ *
+ * A window fails if one of the three p-values is below alpha. After failLimit consecutive failed
+ * windows the drift flag is raised; it stays raised until clearDrift ( ). A misconfigured generator,
+ * e.g. an invalid one after a bad reparametrize ( ) returning only 0, or one with a short period, fails
+ * every window and is flagged after failLimit windows, while a correct generator raises a false alarm
+ * with the defaults less than once in 10^10 windows.
+ *
+ * Memory is fixed: two doubles per sample of a window (the current and the previous window) plus the
+ * cell counts. The monitor must be used by the thread using the generator; values obtained from the ICG
+ * directly can be passed to observe ( ).
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGMonitor.h"
+ *
+ * 	...
+ *
+ * 	ICG icg ( 2147483647, 16807, 1, 12345 );
+ * 	ICGMonitor monitor ( icg );
+ *
+ * 	double u = monitor.rand01 ( );
+ * 	unsigned long x = icg.rand ( );
+ * 	monitor.observe ( x );
+ *
+ * 	if ( monitor.drifted ( ) ) {
+ * 		const ICGMonitor :: Report & r = monitor.lastReport ( );
+ * 		log ( "generator drift: chi2 p=%g, KS p=%g, %llu repeats", r.chiSquarePValue, r.ksPValue, r.repeats );
+ * 	}
+ *
+ */
+class ICGMonitor {
+	public:
+		// results of the latest completed window
+		struct Report {
+			unsigned long long window;		// number of the window, starting at 1
+			size_t samples;
+			double chiSquare, chiSquarePValue;
+			double ks, ksPValue;			// Kolmogorov-Smirnov distance D and its p-value
+			unsigned long long repeats;		// samples equal to an earlier sample of this or the previous window
+			double repeatsPValue;
+			bool failed;
+		};
+
+		// chi-square cells
+		static const unsigned BINS = 64;
+
+		ICGMonitor ( ICG & icg, unsigned k = 1024, size_t window = 4096, double alpha = 1e-4, unsigned failLimit = 3 );
+
+		/**
+		 * Passes an output of the monitored ICG :: rand ( ) to the monitor.
+		 *
+		 * @param x The output, in 0, ..., p-1.
+		 */
+		void observe ( unsigned long x ) {
+			if ( --countdown == 0 ) sample ( x );
+		}
+
+		/**
+		 * Generates a number with ICG :: rand ( ) and passes it to the monitor.
+		 *
+		 * @return The output of ICG :: rand ( ).
+		 */
+		unsigned long rand ( ) {
+			unsigned long x = icg.rand ( );
+			observe ( x );
+			return x;
+		}
+
+		/**
+		 * Generates a number with ICG :: rand01 ( ) and passes the underlying output to the monitor.
+		 *
+		 * @return The same value as ICG :: rand01 ( ).
+		 */
+		double rand01 ( ) {
+			unsigned long x = rand ( );
+			return x ? ( double ) x / ( double ) icg.get_p ( ) : 0.0;
+		}
+
+		void fill ( unsigned long * out, size_t n );
+
+		/**
+		 * Tells whether failLimit consecutive windows have failed since construction or clearDrift ( ).
+		 *
+		 * @return True if the generator output drifted.
+		 */
+		bool drifted ( ) const { return drift; }
+
+		/**
+		 * Lowers the drift flag, e.g. after the generator was repaired.
+		 */
+		void clearDrift ( ) { drift = false; consecutiveFailures = 0; }
+
+		/**
+		 * Returns the results of the latest completed window.
+		 *
+		 * @return The report; its window is 0 before the first window has completed.
+		 */
+		const Report & lastReport ( ) const { return report; }
+
+		/**
+		 * Returns the number of failed windows.
+		 *
+		 * @return Failed windows since construction.
+		 */
+		unsigned long long failedWindows ( ) const { return failures; }
+
+	private:
+		ICG & icg;
+
+		unsigned k, countdown;
+		double alpha;
+		unsigned failLimit;
+
+		// current window: sampled values in [0,1) and the cell counts; previous window: sorted values
+		std :: vector < double > values, previous;
+		size_t filled, previousSize;
+		unsigned long cells [ BINS ];
+
+		Report report;
+		unsigned consecutiveFailures;
+		unsigned long long failures;
+		bool drift;
+
+		void sample ( unsigned long x );
+		void closeWindow ( );
+};
+
+#endif /* __ICGMONITOR_H__ */
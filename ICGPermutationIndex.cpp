@@ -0,0 +1,176 @@
+#include "ICGPermutationIndex.h"
+#include "ICG.h" // using: ICG :: isPrime ( )
+
+/**
+ * Constructs the permutation of [0, n) selected by seed.
+ *
+ * @param n Number of elements, 1 <= n <= 2^62.
+ * @param seed Any value; different seeds give unrelated permutations.
+ */
+ICGPermutationIndex :: ICGPermutationIndex ( unsigned long long n, unsigned long long seed )
+: permutationIsValid ( false ), n ( n ), p ( 0 )
+{
+	if ( n == 0 || n > ( 1ULL << 62 ) ) return;
+
+	p = ( n < 3 ) ? 2 : n - 1;
+	while ( !ICG :: isPrime ( ( unsigned long ) p ) ) p++;
+
+	// The round constants are taken from a splitmix64 sequence started at the seed.
+	unsigned long long state = seed;
+	for ( int k = 0; k < ROUNDS; k++ ) {
+		unsigned long long r [ 3 ];
+		for ( int j = 0; j < 3; j++ ) {
+			state += 0x9e3779b97f4a7c15ULL;
+			unsigned long long z = state;
+			z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+			z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+			r [ j ] = z ^ ( z >> 31 );
+		}
+		a [ k ] = r [ 0 ] % ( p - 1 ) + 1;
+		b [ k ] = r [ 1 ] % p;
+		c [ k ] = r [ 2 ] % ( p + 1 );
+	}
+
+	permutationIsValid = true;
+}
+
+
+/**
+ * Maps an index to its position in the permutation.
+ *
+ * @param i An index < N.
+ * @return The permuted index, or 0 if i >= N or the permutation is invalid.
+ */
+unsigned long long ICGPermutationIndex :: operator ( ) ( unsigned long long i ) const {
+	if ( !permutationIsValid || i >= n ) return 0;
+
+	// Cycle walking: the cycle through i returns to [0, N) no later than at i itself.
+	do {
+		i = step ( i );
+	} while ( i >= n );
+
+	return i;
+}
+
+
+/**
+ * Inverts the permutation, i.e. inverse ( operator ( ) ( i ) ) == i.
+ *
+ * @param y A permuted index < N.
+ * @return The index mapped to y, or 0 if y >= N or the permutation is invalid.
+ */
+unsigned long long ICGPermutationIndex :: inverse ( unsigned long long y ) const {
+	if ( !permutationIsValid || y >= n ) return 0;
+
+	do {
+		y = stepInverse ( y );
+	} while ( y >= n );
+
+	return y;
+}
+
+
+/**
+ * Applies all rounds once to a point of the projective line.
+ *
+ * Private helper method.
+ * Each round is the ICG step x -> a * x^-1 + b, with 0 <-> infinity (= p) under inversion and
+ * infinity fixed by the affine part, followed by the rotation x -> ( x + c ) % ( p + 1 ).
+ *
+ * @param x A point label <= p.
+ * @return The image label <= p.
+ */
+unsigned long long ICGPermutationIndex :: step ( unsigned long long x ) const {
+	for ( int k = 0; k < ROUNDS; k++ ) {
+		if ( x == p ) x = b [ k ];						// infinity -> 0 -> b
+		else if ( x == 0 ) x = p;						// 0 -> infinity -> infinity
+		else {
+			x = mulMod ( a [ k ], invMod ( x ) ) + b [ k ];
+			if ( x >= p ) x -= p;
+		}
+
+		x += c [ k ];
+		if ( x > p ) x -= p + 1;
+	}
+
+	return x;
+}
+
+
+/**
+ * Undoes step ( ).
+ *
+ * Private helper method.
+ *
+ * @param x A point label <= p.
+ * @return The label y with step ( y ) == x.
+ */
+unsigned long long ICGPermutationIndex :: stepInverse ( unsigned long long x ) const {
+	for ( int k = ROUNDS - 1; k >= 0; k-- ) {
+		x = ( x >= c [ k ] ) ? x - c [ k ] : x + ( p + 1 ) - c [ k ];
+
+		if ( x == p ) x = 0;
+		else if ( x == b [ k ] ) x = p;
+		else {
+			unsigned long long d = ( x >= b [ k ] ) ? x - b [ k ] : x + p - b [ k ];
+			x = invMod ( mulMod ( d, invMod ( a [ k ] ) ) );
+		}
+	}
+
+	return x;
+}
+
+
+/**
+ * Multiplies two residues mod p.
+ *
+ * Private helper method.
+ *
+ * @param x An unsigned integer < p.
+ * @param y An unsigned integer < p.
+ * @return ( x * y ) % p
+ */
+unsigned long long ICGPermutationIndex :: mulMod ( unsigned long long x, unsigned long long y ) const {
+#if defined ( __SIZEOF_INT128__ )
+	return ( unsigned long long ) ( ( unsigned __int128 ) x * y % p );
+#else
+	// Double-and-add, since x * y may not fit into 64 bits.
+	unsigned long long result = 0;
+	while ( y != 0 ) {
+		if ( y & 1 ) {
+			result += x;
+			if ( result >= p ) result -= p;
+		}
+		x += x;
+		if ( x >= p ) x -= p;
+		y >>= 1;
+	}
+	return result;
+#endif
+}
+
+
+/**
+ * Calculates the inverse of a nonzero residue mod p with the extended Euclidean algorithm.
+ *
+ * Private helper method.
+ *
+ * @param y A nonzero unsigned integer < p.
+ * @return An unsigned integer z such that ( y*z % p ) == 1
+ */
+unsigned long long ICGPermutationIndex :: invMod ( unsigned long long y ) const {
+	unsigned long long rn = p, rn1 = y;
+	long long Rn = 0, Rn1 = 1;
+
+	while ( rn1 != 0 ) {
+		unsigned long long q = rn / rn1, rn2 = rn % rn1;
+		long long Rn2 = Rn - ( long long ) q * Rn1;
+
+		rn = rn1;
+		rn1 = rn2;
+		Rn = Rn1;
+		Rn1 = Rn2;
+	}
+
+	return ( Rn < 0 ) ? ( unsigned long long ) ( Rn + ( long long ) p ) : ( unsigned long long ) Rn;
+}
@@ -0,0 +1,83 @@
+#ifndef __ICGPERMUTATIONINDEX_H__
+#define __ICGPERMUTATIONINDEX_H__
+
+/**
+ * Random permutation of the integers 0, 1, ..., N-1 with random access and O(1) memory.
+ *
+ * The ICG step x -> a * x^-1 + b is a bijection on the projective line over F_p, i.e. on the
+ * p+1 points 0, 1, ..., p-1 and infinity. Labelling infinity as p, this class uses the step as a
+ * permutation of 0, 1, ..., p where p is the smallest prime with p+1 >= N.
+ * Because a single step is a Moebius transformation, and compositions of those are again Moebius
+ * transformations, each of the ROUNDS rounds follows the step by a rotation of the labels
+ * by a constant, which leaves the group of Moebius maps.
+ * Values that land outside [0, N) are mapped again (cycle walking) until they fall inside, which
+ * costs (p+1)/N rounds on average, i.e. barely more than one since primes are dense.
+ *
+ * The round constants are derived from the seed, so a (N, seed) pair always describes the same permutation.
+ * N may be up to 2^62.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGPermutationIndex.h"
+ *
+ * 	...
+ *
+ * 	ICGPermutationIndex perm ( 1000000000000ULL, 42 );
+ *
+ * 	// visits every key in [0, 10^12) exactly once, in random order
+ * 	for ( unsigned long long i = 0; i < perm.size ( ); i++ ) {
+ * 		visit ( perm ( i ) );
+ * 	}
+ *
+ * 	// perm.inverse ( perm ( i ) ) == i
+ *
+ */
+class ICGPermutationIndex {
+	public:
+		static const int ROUNDS = 3;
+
+		ICGPermutationIndex ( unsigned long long n, unsigned long long seed );
+
+		unsigned long long operator ( ) ( unsigned long long i ) const;
+		unsigned long long inverse ( unsigned long long y ) const;
+
+		/**
+		 * Returns the validity state of the permutation.
+		 *
+		 * A permutation is invalid if N is 0 or larger than 2^62.
+		 * An invalid permutation maps every index to 0.
+		 *
+		 * @return True iff this permutation is valid.
+		 */
+		bool isValid ( ) const { return permutationIsValid; }
+
+		/**
+		 * Returns the number of permuted elements.
+		 *
+		 * @return The permutation size N.
+		 */
+		unsigned long long size ( ) const { return n; }
+
+		/**
+		 * Returns the prime of the underlying projective line.
+		 *
+		 * @return The smallest prime p with p+1 >= N.
+		 */
+		unsigned long long get_p ( ) const { return p; }
+
+	private:
+		bool permutationIsValid;
+
+		unsigned long long n, p;
+		unsigned long long a [ ROUNDS ], b [ ROUNDS ], c [ ROUNDS ];
+
+		unsigned long long step ( unsigned long long x ) const;
+		unsigned long long stepInverse ( unsigned long long x ) const;
+
+		unsigned long long mulMod ( unsigned long long x, unsigned long long y ) const;
+		unsigned long long invMod ( unsigned long long y ) const;
+};
+
+#endif /* __ICGPERMUTATIONINDEX_H__ */
@@ -0,0 +1,118 @@
+#ifndef __ICGRANDOM_H__
+#define __ICGRANDOM_H__
+
+#include "ICG.h"
+#include <random> // using: std::uniform_int_distribution, std::uniform_real_distribution, std::normal_distribution, std::bernoulli_distribution
+
+/**
+ * Drop-in replacements for common <random> distributions with a fast path for ICG.
+ *
+ * ICG satisfies UniformRandomBitGenerator, but the standard distributions only see a 32 bit engine:
+ * std :: uniform_real_distribution < double > needs two engine calls per value through
+ * std :: generate_canonical ( ), and std :: normal_distribution several more.
+ * Each class here derives from its standard counterpart, so constructors, param_type, min ( ), max ( )
+ * and comparisons are unchanged and any other engine still works. Passing an ICG selects an overload
+ * which uses the generator's own methods:
+ *
+ *  - ICGUniformIntDistribution: ICG :: randBounded ( ), one step for ranges up to p, exactly uniform.
+ *  - ICGUniformRealDistribution: ICG :: rand01 ( ), one step, with the generator's resolution of 1/p.
+ *  - ICGNormalDistribution: ICG :: randStdNorm ( ), the polar Box-Muller method.
+ *  - ICGBernoulliDistribution: ICG :: fillBernoulliMask ( ), about two random bits per value.
+ *
+ * Requires C++11.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGRandom.h"
+ *
+ * 	...
+ *
+ * 	ICG icg ( 15485863, 213, 64, 12345 );
+ *
+ * 	ICGUniformIntDistribution < int > die ( 1, 6 );
+ * 	int roll = die ( icg );
+ *
+ * 	ICGNormalDistribution < double > noise ( 0.0, 0.1 );
+ * 	double x = noise ( icg );
+ *
+ * 	// any standard engine works as well
+ * 	std :: mt19937 mt;
+ * 	int other = die ( mt );
+ *
+ */
+template < class IntType = int >
+class ICGUniformIntDistribution : public std :: uniform_int_distribution < IntType > {
+	public:
+		typedef std :: uniform_int_distribution < IntType > base_type;
+		typedef typename base_type :: param_type param_type;
+
+		using base_type :: base_type;
+		using base_type :: operator ( );
+
+		IntType operator ( ) ( ICG & g ) { return ( *this ) ( g, this -> param ( ) ); }
+
+		IntType operator ( ) ( ICG & g, const param_type & parm ) {
+			unsigned long long span = ( unsigned long long ) parm.b ( ) - ( unsigned long long ) parm.a ( );
+			unsigned long long offset;
+			if ( span >= 0xFFFFFFFFFFFFFFFFULL ) offset = g.rand64 ( );
+			else if ( span == 0xFFFFFFFFULL ) offset = g.rand32 ( );
+			else offset = g.randBounded ( ( unsigned long ) ( span + 1 ) );
+			return ( IntType ) ( ( unsigned long long ) parm.a ( ) + offset );
+		}
+};
+
+
+template < class RealType = double >
+class ICGUniformRealDistribution : public std :: uniform_real_distribution < RealType > {
+	public:
+		typedef std :: uniform_real_distribution < RealType > base_type;
+		typedef typename base_type :: param_type param_type;
+
+		using base_type :: base_type;
+		using base_type :: operator ( );
+
+		RealType operator ( ) ( ICG & g ) { return ( *this ) ( g, this -> param ( ) ); }
+
+		RealType operator ( ) ( ICG & g, const param_type & parm ) {
+			return ( RealType ) ( g.rand01 ( ) * ( parm.b ( ) - parm.a ( ) ) + parm.a ( ) );
+		}
+};
+
+
+template < class RealType = double >
+class ICGNormalDistribution : public std :: normal_distribution < RealType > {
+	public:
+		typedef std :: normal_distribution < RealType > base_type;
+		typedef typename base_type :: param_type param_type;
+
+		using base_type :: base_type;
+		using base_type :: operator ( );
+
+		RealType operator ( ) ( ICG & g ) { return ( *this ) ( g, this -> param ( ) ); }
+
+		RealType operator ( ) ( ICG & g, const param_type & parm ) {
+			return ( RealType ) ( g.randStdNorm ( ) * parm.stddev ( ) + parm.mean ( ) );
+		}
+};
+
+
+class ICGBernoulliDistribution : public std :: bernoulli_distribution {
+	public:
+		typedef std :: bernoulli_distribution base_type;
+		typedef base_type :: param_type param_type;
+
+		using base_type :: base_type;
+		using base_type :: operator ( );
+
+		bool operator ( ) ( ICG & g ) { return ( *this ) ( g, this -> param ( ) ); }
+
+		bool operator ( ) ( ICG & g, const param_type & parm ) {
+			unsigned long long word;
+			g.fillBernoulliMask ( &word, 1, parm.p ( ) );
+			return ( word & 1 ) != 0;
+		}
+};
+
+#endif /* __ICGRANDOM_H__ */
@@ -0,0 +1,266 @@
+#ifndef __ICGRANGES_H__
+#define __ICGRANGES_H__
+
+#include "ICG.h"
+
+#if __cplusplus >= 202002L
+
+#include <stddef.h> // using: size_t, ptrdiff_t
+#include <exception> // using: std::terminate ( )
+#include <iterator> // using: std::default_sentinel_t, std::unreachable_sentinel_t
+#include <ranges> // using: std::ranges::view_interface
+#include <utility> // using: std::exchange ( )
+#include <vector> // using: std::vector
+
+#if defined ( __cpp_impl_coroutine )
+#include <coroutine> // using: std::coroutine_handle, std::suspend_always
+#endif
+
+/**
+ * C++20 range and coroutine interfaces to an ICG.
+ *
+ * icg :: view ( gen ) is an infinite input view of the values of gen.rand ( ), and icg :: view01 ( gen )
+ * one of gen.rand01 ( ). Internally they refill a block of values at a time with ICG :: fill ( ) or
+ * ICG :: fill01 ( ), so a pipeline like view ( gen ) | std :: views :: take ( n ) | std :: views :: transform ( f )
+ * costs a buffer read per element instead of an out-of-line rand ( ) call.
+ *
+ * icg :: generate ( gen ) is the same stream as a coroutine-based generator, in the style of C++23
+ * std :: generator, for code that prefers to hold on to a single resumable object.
+ *
+ * Values that have been buffered but not consumed are lost for the generator, so after a view is destroyed
+ * gen continues up to block values further on than the consumed elements suggest.
+ * Views are move-only: a copy would hand out the buffered values twice.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGRanges.h"
+ *
+ * 	...
+ *
+ * 	ICG gen ( 15485863, 213, 64, 12345 );
+ *
+ * 	// sum of 1000 rolls of a die
+ * 	int sum = 0;
+ * 	for ( int roll : icg :: view ( gen ) | std :: views :: take ( 1000 )
+ * 	                                     | std :: views :: transform ( [ ] ( unsigned long x ) { return ( int ) ( x % 6 ) + 1; } ) ) {
+ * 		sum += roll;
+ * 	}
+ *
+ * 	icg :: generator < double > g = icg :: generate01 ( gen );
+ * 	auto it = g.begin ( );
+ * 	double first = *it, second = *++it;
+ *
+ */
+namespace icg {
+
+/**
+ * Infinite input view of generator outputs, refilled block by block.
+ *
+ * @tparam T The value type.
+ * @tparam Fill The ICG bulk method producing values of type T.
+ */
+template < class T, void ( ICG :: *Fill ) ( T *, size_t ) >
+class block_view : public std :: ranges :: view_interface < block_view < T, Fill > > {
+	public:
+		class iterator {
+			public:
+				typedef std :: input_iterator_tag iterator_concept;
+				typedef T value_type;
+				typedef ptrdiff_t difference_type;
+
+				iterator ( ) = default;
+				explicit iterator ( block_view * parent ) : parent ( parent ) { }
+
+				const T & operator * ( ) const { return parent -> buffer [ parent -> pos ]; }
+
+				iterator & operator ++ ( ) {
+					if ( ++parent -> pos == parent -> buffer.size ( ) ) parent -> refill ( );
+					return *this;
+				}
+				void operator ++ ( int ) { ++*this; }
+
+			private:
+				block_view * parent = nullptr;
+		};
+
+		block_view ( ) = default;
+
+		/**
+		 * Creates a view of gen's outputs.
+		 *
+		 * @param gen The generator. It must outlive the view.
+		 * @param block Number of values produced per refill, at least 1.
+		 */
+		explicit block_view ( ICG & gen, size_t block = 256 ) : gen ( &gen ), buffer ( block ? block : 1 ), pos ( buffer.size ( ) ) { }
+
+		block_view ( block_view && ) = default;
+		block_view & operator = ( block_view && ) = default;
+
+		/**
+		 * Returns an iterator to the next value, generating a block if none is buffered.
+		 *
+		 * @return An iterator which advances this view.
+		 */
+		iterator begin ( ) {
+			if ( pos == buffer.size ( ) ) refill ( );
+			return iterator ( this );
+		}
+
+		/**
+		 * Returns the end of the view, which is never reached.
+		 *
+		 * @return std :: unreachable_sentinel
+		 */
+		std :: unreachable_sentinel_t end ( ) const { return std :: unreachable_sentinel; }
+
+	private:
+		ICG * gen = nullptr;
+		std :: vector < T > buffer;
+		size_t pos = 0;
+
+		void refill ( ) {
+			( gen ->* Fill ) ( buffer.data ( ), buffer.size ( ) );
+			pos = 0;
+		}
+};
+
+typedef block_view < unsigned long, &ICG :: fill > rand_view;
+typedef block_view < double, &ICG :: fill01 > rand01_view;
+
+/**
+ * Returns an infinite view of gen.rand ( ) values.
+ *
+ * @param gen The generator. It must outlive the view.
+ * @param block Number of values produced per refill.
+ * @return The view.
+ */
+inline rand_view view ( ICG & gen, size_t block = 256 ) { return rand_view ( gen, block ); }
+
+/**
+ * Returns an infinite view of gen.rand01 ( ) values.
+ *
+ * @param gen The generator. It must outlive the view.
+ * @param block Number of values produced per refill.
+ * @return The view.
+ */
+inline rand01_view view01 ( ICG & gen, size_t block = 256 ) { return rand01_view ( gen, block ); }
+
+
+#if defined ( __cpp_impl_coroutine )
+
+/**
+ * Minimal lazy coroutine generator, a subset of C++23 std :: generator.
+ *
+ * @tparam T The yielded value type.
+ */
+template < class T >
+class generator : public std :: ranges :: view_interface < generator < T > > {
+	public:
+		struct promise_type {
+			const T * current = nullptr;
+
+			generator get_return_object ( ) { return generator ( std :: coroutine_handle < promise_type > :: from_promise ( *this ) ); }
+			std :: suspend_always initial_suspend ( ) noexcept { return { }; }
+			std :: suspend_always final_suspend ( ) noexcept { return { }; }
+			std :: suspend_always yield_value ( const T & value ) noexcept { current = &value; return { }; }
+			void return_void ( ) noexcept { }
+			void unhandled_exception ( ) { std :: terminate ( ); }
+		};
+
+		class iterator {
+			public:
+				typedef std :: input_iterator_tag iterator_concept;
+				typedef T value_type;
+				typedef ptrdiff_t difference_type;
+
+				iterator ( ) = default;
+				explicit iterator ( std :: coroutine_handle < promise_type > handle ) : handle ( handle ) { }
+
+				const T & operator * ( ) const { return *handle.promise ( ).current; }
+
+				iterator & operator ++ ( ) {
+					handle.resume ( );
+					return *this;
+				}
+				void operator ++ ( int ) { ++*this; }
+
+				friend bool operator == ( const iterator & it, std :: default_sentinel_t ) { return !it.handle || it.handle.done ( ); }
+
+			private:
+				std :: coroutine_handle < promise_type > handle;
+		};
+
+		generator ( ) = default;
+		generator ( generator && other ) noexcept : handle ( std :: exchange ( other.handle, nullptr ) ) { }
+		generator & operator = ( generator && other ) noexcept {
+			if ( this != &other ) {
+				if ( handle ) handle.destroy ( );
+				handle = std :: exchange ( other.handle, nullptr );
+			}
+			return *this;
+		}
+		~generator ( ) { if ( handle ) handle.destroy ( ); }
+
+		/**
+		 * Starts the coroutine and returns an iterator to its first value.
+		 * Must be called at most once.
+		 *
+		 * @return An iterator which resumes the coroutine.
+		 */
+		iterator begin ( ) {
+			if ( handle ) handle.resume ( );
+			return iterator ( handle );
+		}
+
+		/**
+		 * Returns the sentinel reached when the coroutine finishes.
+		 *
+		 * @return std :: default_sentinel
+		 */
+		std :: default_sentinel_t end ( ) const { return std :: default_sentinel; }
+
+	private:
+		std :: coroutine_handle < promise_type > handle;
+
+		explicit generator ( std :: coroutine_handle < promise_type > handle ) : handle ( handle ) { }
+};
+
+/**
+ * Yields gen.rand ( ) values forever, produced block by block with ICG :: fill ( ).
+ *
+ * @param gen The generator. It must outlive the coroutine.
+ * @param block Number of values produced per refill.
+ * @return The generator object.
+ */
+inline generator < unsigned long > generate ( ICG & gen, size_t block = 256 ) {
+	std :: vector < unsigned long > buffer ( block ? block : 1 );
+	for ( ;; ) {
+		gen.fill ( buffer.data ( ), buffer.size ( ) );
+		for ( const unsigned long & x : buffer ) co_yield x;
+	}
+}
+
+/**
+ * Yields gen.rand01 ( ) values forever, produced block by block with ICG :: fill01 ( ).
+ *
+ * @param gen The generator. It must outlive the coroutine.
+ * @param block Number of values produced per refill.
+ * @return The generator object.
+ */
+inline generator < double > generate01 ( ICG & gen, size_t block = 256 ) {
+	std :: vector < double > buffer ( block ? block : 1 );
+	for ( ;; ) {
+		gen.fill01 ( buffer.data ( ), buffer.size ( ) );
+		for ( const double & x : buffer ) co_yield x;
+	}
+}
+
+#endif // __cpp_impl_coroutine
+
+} // namespace icg
+
+#endif // __cplusplus >= 202002L
+
+#endif /* __ICGRANGES_H__ */
@@ -0,0 +1,309 @@
+#ifndef __ICGRESERVOIR_H__
+#define __ICGRESERVOIR_H__
+
+#include "ICG.h"
+#include <stddef.h> // using: size_t
+#include <math.h> // using: log ( ), exp ( ), floor ( ), HUGE_VAL
+#include <algorithm> // using: std::push_heap ( ), std::pop_heap ( )
+#include <vector> // using: std::vector
+
+/**
+ * Uniform reservoir sampling of k items from a stream of unknown length.
+ *
+ * Uses Li's Algorithm L: instead of one random number per stream item, the sampler draws
+ * the number of items to skip before the next replacement from its geometric-like distribution.
+ * A stream of n items therefore needs only O ( k * ( 1 + log ( n / k ) ) ) random numbers.
+ *
+ * Items can be offered one by one with add ( ). Producers that can skip records cheaply
+ * (e.g. without parsing them) can ask skipCount ( ) how many upcoming items will be ignored
+ * and jump over them with skip ( ).
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGReservoir.h"
+ *
+ * 	...
+ *
+ * 	ICG icg ( 15485863, 213, 64, 12345 );
+ * 	ICGReservoir < Record > reservoir ( icg, 100 );
+ *
+ * 	while ( stream.hasMore ( ) ) {
+ * 		unsigned long long ignored = reservoir.skipCount ( );
+ * 		reservoir.skip ( stream.skipRecords ( ignored ) );
+ * 		if ( stream.hasMore ( ) ) reservoir.add ( stream.nextRecord ( ) );
+ * 	}
+ *
+ * 	// uniform sample of 100 records (fewer if the stream was shorter)
+ * 	const std :: vector < Record > & sample = reservoir.sample ( );
+ *
+ */
+template < class T >
+class ICGReservoir {
+	public:
+		ICGReservoir ( ICG & icg, size_t k );
+
+		void add ( const T & item );
+		void skip ( unsigned long long count );
+		void reset ( );
+
+		/**
+		 * Returns the number of upcoming items which will not enter the reservoir.
+		 *
+		 * @return How many items may be passed to skip ( ) instead of add ( ).
+		 */
+		unsigned long long skipCount ( ) const { return ( items.size ( ) < k ) ? 0 : next - count; }
+
+		/**
+		 * Returns the number of stream items seen so far, skipped ones included.
+		 *
+		 * @return The stream position.
+		 */
+		unsigned long long seen ( ) const { return count; }
+
+		/**
+		 * Returns the current sample.
+		 *
+		 * @return Up to k uniformly chosen items of the stream seen so far, in no particular order.
+		 */
+		const std :: vector < T > & sample ( ) const { return items; }
+
+	private:
+		ICG & icg;
+		size_t k;
+
+		std :: vector < T > items;
+
+		// count: items seen; next: stream index of the next item entering the reservoir
+		unsigned long long count, next;
+		double W;
+
+		double uniform ( ) { return 1.0 - icg.rand01 ( ); }
+		void advance ( );
+};
+
+
+/**
+ * Weighted reservoir sampling of k items from a stream of unknown length.
+ *
+ * Uses the A-ExpJ algorithm of Efraimidis and Spirakis: each item conceptually receives the key
+ * u^(1/w) for its weight w, and the k items with the largest keys form the sample. Instead of one
+ * key per item, an exponential jump tells how much stream weight passes before the next item enters
+ * the reservoir, so items in between only cost a subtraction.
+ * Keys are kept as logarithms to avoid underflow for large weights.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	ICGWeightedReservoir < Record > reservoir ( icg, 100 );
+ *
+ * 	for ( ... ) reservoir.add ( record, record.weight );
+ *
+ * 	const std :: vector < Record > & sample = reservoir.sample ( );
+ *
+ */
+template < class T >
+class ICGWeightedReservoir {
+	public:
+		ICGWeightedReservoir ( ICG & icg, size_t k );
+
+		void add ( const T & item, double weight );
+		void reset ( );
+
+		/**
+		 * Returns the current sample.
+		 *
+		 * @return Up to k items of the stream seen so far, chosen without replacement with probability proportional to their weights.
+		 */
+		const std :: vector < T > & sample ( ) const { return items; }
+
+	private:
+		ICG & icg;
+		size_t k;
+
+		// heap holds ( log-key, index into items ) pairs, ordered as a min-heap on the log-key
+		std :: vector < T > items;
+		std :: vector < std :: pair < double, size_t > > heap;
+
+		// remaining weight until the next item enters the reservoir
+		double jump;
+
+		double uniform ( ) { return 1.0 - icg.rand01 ( ); }
+		void newJump ( );
+
+		static bool keyGreater ( const std :: pair < double, size_t > & x, const std :: pair < double, size_t > & y ) { return x.first > y.first; }
+};
+
+
+/**
+ * Constructs an empty reservoir of size k.
+ *
+ * @param icg The generator to draw from. It must outlive the reservoir.
+ * @param k The sample size.
+ */
+template < class T >
+ICGReservoir < T > :: ICGReservoir ( ICG & icg, size_t k )
+: icg ( icg ), k ( k ), count ( 0 ), next ( 0 ), W ( 1.0 )
+{
+	items.reserve ( k );
+}
+
+
+/**
+ * Offers the next stream item.
+ *
+ * @param item The item, copied into the reservoir if selected.
+ */
+template < class T >
+void ICGReservoir < T > :: add ( const T & item ) {
+	if ( k == 0 ) { count++; return; }
+
+	if ( items.size ( ) < k ) {
+		items.push_back ( item );
+		count++;
+		if ( items.size ( ) == k ) {
+			W = exp ( log ( uniform ( ) ) / k );
+			next = count - 1;
+			advance ( );
+		}
+		return;
+	}
+
+	if ( count == next ) {
+		items [ icg.randBounded ( ( unsigned long ) k ) ] = item;
+		W *= exp ( log ( uniform ( ) ) / k );
+		advance ( );
+	}
+	count++;
+}
+
+
+/**
+ * Passes over stream items without offering them.
+ *
+ * Skipping more than skipCount ( ) items is allowed; the sample then simply misses the
+ * items that would have been selected among the skipped ones.
+ *
+ * @param skipped The number of items passed over.
+ */
+template < class T >
+void ICGReservoir < T > :: skip ( unsigned long long skipped ) {
+	count += skipped;
+	if ( items.size ( ) == k && k != 0 ) {
+		while ( next < count ) {
+			W *= exp ( log ( uniform ( ) ) / k );
+			advance ( );
+		}
+	}
+}
+
+
+/**
+ * Empties the reservoir and restarts at stream position 0.
+ */
+template < class T >
+void ICGReservoir < T > :: reset ( ) {
+	items.clear ( );
+	count = 0;
+	next = 0;
+	W = 1.0;
+}
+
+
+/**
+ * Moves next to the stream index of the next item entering the reservoir.
+ *
+ * Private helper method.
+ * The gap to the next replacement is geometric with success probability W.
+ */
+template < class T >
+void ICGReservoir < T > :: advance ( ) {
+	double gap = floor ( log ( uniform ( ) ) / log ( 1.0 - W ) );
+
+	// W can round to 1 (tiny streams) or the gap overflow (huge streams)
+	if ( !( gap >= 0.0 ) ) gap = 0.0;
+	if ( gap > 1e18 ) gap = 1e18;
+
+	next += ( unsigned long long ) gap + 1;
+}
+
+
+/**
+ * Constructs an empty weighted reservoir of size k.
+ *
+ * @param icg The generator to draw from. It must outlive the reservoir.
+ * @param k The sample size.
+ */
+template < class T >
+ICGWeightedReservoir < T > :: ICGWeightedReservoir ( ICG & icg, size_t k )
+: icg ( icg ), k ( k ), jump ( 0.0 )
+{
+	items.reserve ( k );
+	heap.reserve ( k );
+}
+
+
+/**
+ * Offers the next stream item with the given weight.
+ *
+ * Items with nonpositive weight are never selected.
+ *
+ * @param item The item, copied into the reservoir if selected.
+ * @param weight The item's weight.
+ */
+template < class T >
+void ICGWeightedReservoir < T > :: add ( const T & item, double weight ) {
+	if ( k == 0 || !( weight > 0.0 ) ) return;
+
+	if ( items.size ( ) < k ) {
+		heap.push_back ( std :: make_pair ( log ( uniform ( ) ) / weight, items.size ( ) ) );
+		std :: push_heap ( heap.begin ( ), heap.end ( ), keyGreater );
+		items.push_back ( item );
+		if ( items.size ( ) == k ) newJump ( );
+		return;
+	}
+
+	jump -= weight;
+	if ( jump > 0.0 ) return;
+
+	// The new key is uniform on ( minKey^weight, 1 ) raised to 1/weight.
+	double threshold = exp ( weight * heap.front ( ).first );
+	double key = log ( threshold + ( 1.0 - threshold ) * uniform ( ) ) / weight;
+
+	std :: pop_heap ( heap.begin ( ), heap.end ( ), keyGreater );
+	size_t slot = heap.back ( ).second;
+	heap.back ( ) = std :: make_pair ( key, slot );
+	std :: push_heap ( heap.begin ( ), heap.end ( ), keyGreater );
+	items [ slot ] = item;
+
+	newJump ( );
+}
+
+
+/**
+ * Empties the reservoir.
+ */
+template < class T >
+void ICGWeightedReservoir < T > :: reset ( ) {
+	items.clear ( );
+	heap.clear ( );
+	jump = 0.0;
+}
+
+
+/**
+ * Draws the stream weight passing before the next replacement.
+ *
+ * Private helper method.
+ * With T the smallest key in the reservoir, the jump is log ( u ) / log ( T ).
+ * If every key is 1 no later item can enter.
+ */
+template < class T >
+void ICGWeightedReservoir < T > :: newJump ( ) {
+	double logMinKey = heap.front ( ).first;
+	jump = ( logMinKey < 0.0 ) ? log ( uniform ( ) ) / logMinKey : HUGE_VAL;
+}
+
+#endif /* __ICGRESERVOIR_H__ */
@@ -0,0 +1,149 @@
+#include "ICGSequentialSample.h"
+#include <math.h> // using: exp ( ), log ( ), floor ( )
+
+/**
+ * Prepares the selection of k out of the indices 0, 1, ..., n-1.
+ *
+ * @param icg The generator to draw from. It must outlive the sampler.
+ * @param k The number of indices to select. If k > n, all n indices are selected.
+ * @param n The number of indices to select from.
+ */
+ICGSequentialSample :: ICGSequentialSample ( ICG & icg, unsigned long long k, unsigned long long n )
+: icg ( icg ), toSelect ( k < n ? k : n ), recordsLeft ( n ), position ( 0 ), Vprime ( 0.0 ), haveVprime ( false )
+{
+}
+
+
+/**
+ * Produces the next selected index.
+ *
+ * @param index Receives the selected index, which is larger than all previously produced ones.
+ * @return False iff all k indices have been produced or the generator is invalid; index is left unchanged then.
+ */
+bool ICGSequentialSample :: next ( unsigned long long & index ) {
+	if ( toSelect == 0 || !icg.isValid ( ) ) return false;
+
+	unsigned long long skip;
+	if ( toSelect == 1 ) {
+		if ( recordsLeft <= ~0UL ) {
+			skip = icg.randBounded ( ( unsigned long ) recordsLeft );
+		} else {
+			skip = ( unsigned long long ) floor ( recordsLeft * ( 1.0 - uniform ( ) ) );
+			if ( skip >= recordsLeft ) skip = recordsLeft - 1;
+		}
+	} else if ( 13 * toSelect < recordsLeft ) {
+		skip = skipD ( );
+	} else {
+		haveVprime = false;
+		skip = skipA ( );
+	}
+
+	index = position + skip;
+	position = index + 1;
+	recordsLeft -= skip + 1;
+	toSelect--;
+
+	return true;
+}
+
+
+/**
+ * Draws the number of records to skip before the next selected one with Vitter's Algorithm D.
+ *
+ * Private helper method.
+ * The skip is generated by rejection from a continuous approximation of its distribution;
+ * the exact acceptance test is only evaluated when the cheap squeeze test fails.
+ *
+ * @return The number of records preceding the next selected one, < recordsLeft.
+ */
+unsigned long long ICGSequentialSample :: skipD ( ) {
+	double n = ( double ) toSelect, N = ( double ) recordsLeft;
+	double ninv = 1.0 / n, nmin1inv = 1.0 / ( n - 1.0 );
+	double qu1 = N - n + 1.0;
+
+	if ( !haveVprime ) Vprime = exp ( log ( uniform ( ) ) * ninv );
+
+	for ( ;; ) {
+		double X, S;
+		for ( ;; ) {
+			X = N * ( 1.0 - Vprime );
+			S = floor ( X );
+			if ( S < qu1 ) break;
+			Vprime = exp ( log ( uniform ( ) ) * ninv );
+		}
+
+		double U = uniform ( );
+		double y1 = exp ( log ( U * N / qu1 ) * nmin1inv );
+		Vprime = y1 * ( 1.0 - X / N ) * ( qu1 / ( qu1 - S ) );
+
+		// Squeeze test. On acceptance Vprime is distributed like U^(1/(n-1)) and is reused by the next step.
+		if ( Vprime <= 1.0 ) {
+			haveVprime = true;
+			return ( unsigned long long ) S;
+		}
+
+		// Exact test
+		double y2 = 1.0, top = N - 1.0, bottom, limit;
+		if ( n - 1.0 > S ) {
+			bottom = N - n;
+			limit = N - S;
+		} else {
+			bottom = N - S - 1.0;
+			limit = qu1;
+		}
+		for ( double t = N - 1.0; t >= limit; t-- ) {
+			y2 = ( y2 * top ) / bottom;
+			top--;
+			bottom--;
+		}
+
+		if ( N / ( N - X ) >= y1 * exp ( log ( y2 ) * nmin1inv ) ) {
+			Vprime = exp ( log ( uniform ( ) ) * nmin1inv );
+			haveVprime = true;
+			return ( unsigned long long ) S;
+		}
+
+		Vprime = exp ( log ( uniform ( ) ) * ninv );
+	}
+}
+
+
+/**
+ * Draws the number of records to skip before the next selected one with Vitter's Algorithm A.
+ *
+ * Private helper method.
+ * Inverts the distribution function of the skip by sequential search, which takes O ( skip ) time.
+ *
+ * @return The number of records preceding the next selected one, < recordsLeft.
+ */
+unsigned long long ICGSequentialSample :: skipA ( ) {
+	double top = ( double ) ( recordsLeft - toSelect ), N = ( double ) recordsLeft;
+	double V = 1.0 - uniform ( ), quot = top / N;
+	unsigned long long S = 0;
+
+	while ( quot > V ) {
+		S++;
+		top--;
+		N--;
+		quot = ( quot * top ) / N;
+	}
+
+	return S;
+}
+
+
+/**
+ * Generates a uniformly distributed number in (0, 1] from two generator outputs.
+ *
+ * Private helper method.
+ * ( x1 + ( x2 + 1 ) / p ) / p takes p^2 equally spaced values, so the skips of Algorithms A and D
+ * are not limited to the p values of a single ICG :: rand01 ( ).
+ *
+ * @return A random number in (0, 1].
+ */
+double ICGSequentialSample :: uniform ( ) {
+	double p = ( double ) icg.get_p ( );
+	double hi = ( double ) icg.rand ( );
+	double lo = ( double ) icg.rand ( ) + 1.0;
+	return ( hi + lo / p ) / p;
+}
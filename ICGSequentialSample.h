@@ -0,0 +1,116 @@
+#ifndef __ICGSEQUENTIALSAMPLE_H__
+#define __ICGSEQUENTIALSAMPLE_H__
+
+#include "ICG.h"
+#include <stddef.h> // using: ptrdiff_t
+#include <iterator> // using: std::input_iterator_tag
+
+/**
+ * Sequential random sampling without replacement.
+ *
+ * Selects k of the indices 0, 1, ..., n-1 uniformly at random and produces them in increasing order.
+ * Uses Vitter's Algorithm D: rather than testing every index, it draws the number of indices to skip
+ * before the next selected one, which takes O ( k ) expected time, about 2k generator outputs and O ( 1 ) memory.
+ * When the selected indices become dense (13 * remaining k >= remaining n) it switches to Vitter's
+ * Algorithm A, which is cheaper in that regime.
+ *
+ * The indices can be pulled with next ( ) or iterated over with begin ( ) / end ( ), e.g. to feed
+ * file offsets into an I/O pipeline. Index arithmetic uses doubles, so n should stay below 2^53.
+ * The skips are computed from uniforms made of two generator outputs, with a resolution of 1 / p^2
+ * (the full 53 bits of a double for p >= 2^27), and the last index is drawn with ICG :: randBounded ( ),
+ * so every index can be selected even when n is far above p.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGSequentialSample.h"
+ *
+ * 	...
+ *
+ * 	ICG icg ( 15485863, 213, 64, 12345 );
+ *
+ * 	// 1000 distinct record numbers out of 10^12, ascending
+ * 	ICGSequentialSample sample ( icg, 1000, 1000000000000ULL );
+ * 	for ( ICGSequentialSample :: iterator it = sample.begin ( ); it != sample.end ( ); ++it ) {
+ * 		readRecord ( *it );
+ * 	}
+ *
+ */
+class ICGSequentialSample {
+	public:
+		ICGSequentialSample ( ICG & icg, unsigned long long k, unsigned long long n );
+
+		bool next ( unsigned long long & index );
+
+		/**
+		 * Returns the number of indices not yet produced.
+		 *
+		 * @return How many more times next ( ) will succeed with a valid generator.
+		 */
+		unsigned long long remaining ( ) const { return toSelect; }
+
+		/**
+		 * Input iterator over the remaining selected indices.
+		 *
+		 * Like std :: istream_iterator, all iterators share the sampler's state, so a range can only be traversed once.
+		 */
+		class iterator {
+			public:
+				typedef std :: input_iterator_tag iterator_category;
+				typedef unsigned long long value_type;
+				typedef ptrdiff_t difference_type;
+				typedef const unsigned long long * pointer;
+				typedef const unsigned long long & reference;
+
+				iterator ( ) : sample ( 0 ), index ( 0 ) { }
+				explicit iterator ( ICGSequentialSample * sample ) : sample ( sample ), index ( 0 ) { ++*this; }
+
+				reference operator * ( ) const { return index; }
+				pointer operator -> ( ) const { return &index; }
+
+				iterator & operator ++ ( ) {
+					if ( sample && !sample -> next ( index ) ) sample = 0;
+					return *this;
+				}
+				iterator operator ++ ( int ) { iterator old = *this; ++*this; return old; }
+
+				bool operator == ( const iterator & other ) const { return sample == other.sample; }
+				bool operator != ( const iterator & other ) const { return sample != other.sample; }
+
+			private:
+				ICGSequentialSample * sample;
+				unsigned long long index;
+		};
+
+		/**
+		 * Returns an iterator to the next selected index.
+		 *
+		 * @return An iterator which produces the remaining indices.
+		 */
+		iterator begin ( ) { return iterator ( this ); }
+
+		/**
+		 * Returns the past-the-end iterator.
+		 *
+		 * @return An iterator comparing equal to an exhausted iterator.
+		 */
+		iterator end ( ) { return iterator ( ); }
+
+	private:
+		ICG & icg;
+
+		// toSelect of the records [ position, position + recordsLeft ) remain to be selected
+		unsigned long long toSelect, recordsLeft, position;
+
+		// U^(1/toSelect) carried over between steps of Algorithm D
+		double Vprime;
+		bool haveVprime;
+
+		double uniform ( );
+
+		unsigned long long skipD ( );
+		unsigned long long skipA ( );
+};
+
+#endif /* __ICGSEQUENTIALSAMPLE_H__ */
@@ -0,0 +1,152 @@
+#ifndef __ICGSHUFFLE_H__
+#define __ICGSHUFFLE_H__
+
+#include "ICG.h"
+#include <stddef.h> // using: size_t
+#include <algorithm> // using: std::iter_swap ( )
+#include <iterator> // using: std::iterator_traits
+#include <thread> // using: std::thread
+#include <vector> // using: std::vector
+
+/**
+ * Parallel random permutation of large arrays driven by an inversive congruential generator.
+ *
+ * Arrays much larger than the CPU caches are shuffled with MergeShuffle
+ * (Bacher, Bodini, Hollender, Lumbroso): the array is cut into a power-of-two number of blocks,
+ * every block is shuffled in its own thread with ICG :: shuffle ( ), and neighbouring blocks
+ * are then merged pairwise. Each merge interleaves the two halves by coin flips and finishes with
+ * a short Fisher-Yates pass. The memory traffic is sequential and the work is spread over all cores.
+ *
+ * Block k uses a copy of the passed ICG advanced by jump ( k * ( p / blocks ) ), so the blocks draw
+ * from disjoint parts of the period as long as none needs more than p / blocks values. The result is
+ * uniform only as far as these substreams behave like independent random sources, and the
+ * substreams of large arrays are long only for a p well above the number of elements.
+ * The result is deterministic for a given generator state and thread count. Afterwards the passed
+ * generator is moved to a position drawn from its own sequence, so that another call uses other
+ * substreams.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGShuffle.h"
+ *
+ * 	...
+ *
+ * 	ICG icg ( 15485863, 213, 64, 12345 );
+ * 	std :: vector < unsigned > v ( 1000000000 );
+ *
+ * 	// uses std :: thread :: hardware_concurrency ( ) threads
+ * 	ICGShuffle :: shuffle ( icg, v.begin ( ), v.end ( ) );
+ *
+ */
+class ICGShuffle {
+	public:
+		/**
+		 * Below this number of elements the sequential ICG :: shuffle ( ) is used.
+		 */
+		static const size_t MIN_BLOCK = 1 << 20;
+
+		template < class RandomIt >
+		static void shuffle ( ICG & icg, RandomIt first, RandomIt last, unsigned threads = 0 );
+
+	private:
+		template < class RandomIt >
+		static void merge ( ICG & icg, RandomIt first, size_t mid, size_t n );
+};
+
+
+/**
+ * Randomly permutes the elements in [first, last) using several threads.
+ *
+ * Ranges shorter than MIN_BLOCK elements, or a single thread, fall back to icg.shuffle ( ).
+ * If the generator is invalid the range is left unchanged.
+ *
+ * @param icg Generator whose substreams drive the blocks; it is advanced to a new position.
+ * @param first Random access iterator to the first element.
+ * @param last Random access iterator past the last element.
+ * @param threads Number of threads, 0 selects std :: thread :: hardware_concurrency ( ).
+ */
+template < class RandomIt >
+void ICGShuffle :: shuffle ( ICG & icg, RandomIt first, RandomIt last, unsigned threads ) {
+	typedef typename std :: iterator_traits < RandomIt > :: difference_type diff_t;
+
+	if ( !icg.isValid ( ) ) return;
+	if ( threads == 0 ) threads = std :: thread :: hardware_concurrency ( );
+
+	size_t n = ( size_t ) ( last - first );
+
+	size_t blocks = 1;
+	while ( blocks < threads ) blocks *= 2;
+	while ( blocks > 1 && n / blocks < MIN_BLOCK ) blocks /= 2;
+
+	if ( blocks == 1 ) {
+		icg.shuffle ( first, last );
+		return;
+	}
+
+	// disjoint substreams, one per block
+	unsigned long long stride = icg.get_p ( ) / blocks;
+	std :: vector < ICG > gens;
+	gens.reserve ( blocks );
+	for ( size_t k = 0; k < blocks; k++ ) {
+		gens.push_back ( icg );
+		gens.back ( ).jump ( k * stride );
+	}
+	icg.jump ( icg.rand ( ) );
+
+	// Shuffle the blocks independently, then merge neighbours until one block is left.
+	for ( size_t width = 1; width <= blocks; width *= 2 ) {
+		std :: vector < std :: thread > workers;
+		for ( size_t k = 0; k < blocks; k += width ) {
+			size_t lo = k * n / blocks, hi = ( k + width ) * n / blocks;
+			size_t mid = ( k + width / 2 ) * n / blocks;
+			ICG * gen = &gens [ k ];
+			RandomIt base = first + ( diff_t ) lo;
+
+			if ( width == 1 ) {
+				workers.push_back ( std :: thread ( [ = ] ( ) { gen -> shuffle ( base, base + ( diff_t ) ( hi - lo ) ); } ) );
+			} else {
+				workers.push_back ( std :: thread ( [ = ] ( ) { merge ( *gen, base, mid - lo, hi - lo ); } ) );
+			}
+		}
+		for ( size_t k = 0; k < workers.size ( ); k++ ) workers [ k ].join ( );
+	}
+}
+
+
+/**
+ * Merges two uniformly shuffled runs [0, mid) and [mid, n) into one uniformly shuffled run.
+ *
+ * Private helper method.
+ * Coin flips decide whether the next element comes from the left or the right run until one run
+ * is exhausted; the remaining elements are inserted at uniformly random positions.
+ *
+ * @param icg Generator of this merge.
+ * @param first Random access iterator to the first element of the left run.
+ * @param mid Length of the left run.
+ * @param n Total length of both runs.
+ */
+template < class RandomIt >
+void ICGShuffle :: merge ( ICG & icg, RandomIt first, size_t mid, size_t n ) {
+	typedef typename std :: iterator_traits < RandomIt > :: difference_type diff_t;
+
+	size_t i = 0, j = mid;
+
+	for ( ;; ) {
+		if ( icg.randBit ( ) ) {
+			if ( j == n ) break;
+			std :: iter_swap ( first + ( diff_t ) i, first + ( diff_t ) j );
+			j++;
+		} else {
+			if ( i == j ) break;
+		}
+		i++;
+	}
+
+	for ( ; i < n; i++ ) {
+		std :: iter_swap ( first + ( diff_t ) i, first + ( diff_t ) icg.randBounded ( ( unsigned long ) ( i + 1 ) ) );
+	}
+}
+
+#endif /* __ICGSHUFFLE_H__ */
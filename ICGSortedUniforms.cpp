@@ -0,0 +1,68 @@
+#include "ICGSortedUniforms.h"
+#include <math.h> // using: exp ( ), log ( )
+
+/**
+ * Prepares the streaming generation of n sorted uniforms.
+ *
+ * @param icg The generator to draw from. It must outlive this object.
+ * @param n The number of values to produce.
+ */
+ICGSortedUniforms :: ICGSortedUniforms ( ICG & icg, unsigned long long n )
+: icg ( icg ), left ( n ), curMax ( 1.0 )
+{
+}
+
+
+/**
+ * Produces the next value in ascending order.
+ *
+ * @param u Receives a value in [0,1), not smaller than all previously produced ones.
+ * @return False iff all n values have been produced; u is left unchanged then.
+ */
+bool ICGSortedUniforms :: next ( double & u ) {
+	if ( left == 0 ) return false;
+
+	// 1 - rand01 ( ) lies in (0,1], so the logarithm is finite.
+	curMax *= exp ( log ( 1.0 - icg.rand01 ( ) ) / ( double ) left );
+	left--;
+
+	u = 1.0 - curMax;
+	return true;
+}
+
+
+/**
+ * Writes n uniformly distributed values in ascending order.
+ *
+ * With E_1, ..., E_(n+1) independent exponential variates and S_i = E_1 + ... + E_i,
+ * the values S_1 / S_(n+1), ..., S_n / S_(n+1) are distributed like n sorted uniforms.
+ * If the generator is invalid the buffer is filled with zeros.
+ *
+ * @param icg The generator to draw from.
+ * @param out Buffer for n values in [0,1).
+ * @param n The number of values.
+ */
+void ICGSortedUniforms :: fill ( ICG & icg, double * out, size_t n ) {
+	if ( !icg.isValid ( ) ) {
+		for ( size_t i = 0; i < n; i++ ) out [ i ] = 0.0;
+		return;
+	}
+
+	// ( rand ( ) + 1 ) / ( p + 1 ) lies in (0,1), so every spacing is finite and strictly positive
+	// and S_n < S_(n+1).
+	const double range = ( double ) icg.get_p ( ) + 1.0;
+	double sum = 0.0;
+	for ( size_t i = 0; i < n; i++ ) {
+		sum -= log ( ( icg.rand ( ) + 1.0 ) / range );
+		out [ i ] = sum;
+	}
+	sum -= log ( ( icg.rand ( ) + 1.0 ) / range );
+
+	// The last spacing can still be lost to rounding against a large sum; keep the values below 1.
+	const double belowOne = 1.0 - 1.0 / 9007199254740992.0;	// 1 - 2^-53
+	double scale = 1.0 / sum;
+	for ( size_t i = 0; i < n; i++ ) {
+		double u = out [ i ] * scale;
+		out [ i ] = ( u < 1.0 ) ? u : belowOne;
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef __ICGSORTEDUNIFORMS_H__
+#define __ICGSORTEDUNIFORMS_H__
+
+#include "ICG.h"
+#include <stddef.h> // using: size_t
+
+/**
+ * Generation of n uniformly distributed numbers in ascending order in O ( n ) time.
+ *
+ * Sorting n outputs of rand01 ( ) costs O ( n log n ) time and needs all n values at once.
+ * This class produces the order statistics of n uniform values directly:
+ *
+ *  - next ( ) streams them with O ( 1 ) memory using the method of Bentley and Saxe:
+ *    the maximum of i uniforms is distributed like U^(1/i), so walking down from the largest value,
+ *    M_n = U^(1/n) and M_i = M_(i+1) * U^(1/i). Emitting 1 - M_n, 1 - M_(n-1), ... gives ascending order.
+ *
+ *  - fill ( ) writes them into a buffer as normalized cumulative sums of n+1 exponential spacings,
+ *    which needs one logarithm per value and accumulates less rounding error.
+ *
+ * Both are meant for quantile and inverse-transform sampling, where sorted uniforms are consumed in order.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGSortedUniforms.h"
+ *
+ * 	...
+ *
+ * 	ICG icg ( 15485863, 213, 64, 12345 );
+ *
+ * 	// 10^9 ascending uniforms without a buffer
+ * 	ICGSortedUniforms sorted ( icg, 1000000000 );
+ * 	double u;
+ * 	while ( sorted.next ( u ) ) consume ( inverseCdf ( u ) );
+ *
+ * 	// or into a buffer
+ * 	std :: vector < double > v ( 1000 );
+ * 	ICGSortedUniforms :: fill ( icg, &v [ 0 ], v.size ( ) );
+ *
+ */
+class ICGSortedUniforms {
+	public:
+		ICGSortedUniforms ( ICG & icg, unsigned long long n );
+
+		bool next ( double & u );
+
+		/**
+		 * Returns the number of values not yet produced.
+		 *
+		 * @return How many more times next ( ) will succeed.
+		 */
+		unsigned long long remaining ( ) const { return left; }
+
+		static void fill ( ICG & icg, double * out, size_t n );
+
+	private:
+		ICG & icg;
+
+		unsigned long long left;
+
+		// largest of the remaining values, measured downwards from 1
+		double curMax;
+};
+
+#endif /* __ICGSORTEDUNIFORMS_H__ */
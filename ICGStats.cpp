@@ -0,0 +1,41 @@
+#include "ICGStats.h"
+#include <stdio.h> // using: snprintf ( )
+
+/**
+ * Formats the counters in the Prometheus text exposition format.
+ *
+ * Every counter becomes a metric of type counter named icg_<counter>_total, e.g.
+ *
+ * 	# HELP icg_rand_calls_total Calls of ICG::rand().
+ * 	# TYPE icg_rand_calls_total counter
+ * 	icg_rand_calls_total{service="sim"} 123456
+ *
+ * @param labels Label pairs put between the braces, e.g. "thread=\"3\"", or empty for none.
+ * @return The metrics, one line per sample, ending with a newline.
+ */
+std :: string ICGStats :: toPrometheus ( const std :: string & labels ) const {
+	struct Metric {
+		const char * name;
+		const char * help;
+		unsigned long long value;
+	};
+	const Metric metrics [ ] = {
+		{ "icg_rand_calls_total", "Calls of ICG::rand().", randCalls },
+		{ "icg_inversions_total", "Modular inversions.", inversions },
+		{ "icg_euclid_iterations_total", "Iterations of the extended Euclidean algorithm.", euclidIterations },
+		{ "icg_normal_rejections_total", "Candidate pairs rejected by randStdNorm().", normalRejections },
+		{ "icg_normal_cache_hits_total", "randStdNorm() calls served from the cached value.", normalCacheHits },
+		{ "icg_invalid_zero_returns_total", "Values returned as 0 by an invalid generator.", invalidZeroReturns }
+	};
+
+	const std :: string selector = labels.empty ( ) ? "" : "{" + labels + "}";
+	std :: string out;
+	for ( size_t i = 0; i < sizeof ( metrics ) / sizeof ( metrics [ 0 ] ); i++ ) {
+		char value [ 32 ];
+		snprintf ( value, sizeof ( value ), "%llu", metrics [ i ].value );
+		out += std :: string ( "# HELP " ) + metrics [ i ].name + " " + metrics [ i ].help + "\n";
+		out += std :: string ( "# TYPE " ) + metrics [ i ].name + " counter\n";
+		out += std :: string ( metrics [ i ].name ) + selector + " " + value + "\n";
+	}
+	return out;
+}
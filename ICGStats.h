@@ -0,0 +1,73 @@
+#ifndef __ICGSTATS_H__
+#define __ICGSTATS_H__
+
+#include <string> // using: std::string
+
+/**
+ * Instrumentation counters of an ICG.
+ *
+ * The counters are only maintained when the library is compiled with ICG_STATS defined
+ * (e.g. -DICG_STATS); otherwise they stay 0 and the generation methods contain no counting code at all.
+ * ICG_STATS changes the layout of class ICG, so it must be defined for all translation units or for none;
+ * ICG.h places the class in a namespace named after the setting, so a mismatch is a link error.
+ * Without ICG_STATS, ICG.h does not include this header.
+ *
+ * The counters are plain members of each generator. Since a generator is used by one thread at a time,
+ * this is per-thread accumulation without atomic operations; a snapshot ( ICG :: getStats ( ) ) must be
+ * taken by the thread using the generator, and snapshots of several generators are combined with +=.
+ * toPrometheus ( ) formats a snapshot in the Prometheus text exposition format.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	// compile everything with -DICG_STATS
+ * 	#include "ICG.h"
+ * 	#include "ICGStats.h"
+ *
+ * 	...
+ *
+ * 	// per worker thread
+ * 	ICG icg ( 15485863, 213, 64, 12345 );
+ * 	...
+ * 	ICGStats mine = icg.getStats ( );
+ *
+ * 	// collected from all workers
+ * 	ICGStats total;
+ * 	total += mine;
+ * 	std :: string metrics = total.toPrometheus ( "service=\"sim\"" );
+ *
+ */
+struct ICGStats {
+	unsigned long long randCalls;			// calls of rand ( ), directly or through the other methods
+	unsigned long long inversions;			// modular inversions, by Euclid or (constant-work mode) by exponentiation
+	unsigned long long euclidIterations;	// division steps of the extended Euclidean algorithm
+	unsigned long long normalRejections;	// candidate pairs rejected by the polar method in randStdNorm ( )
+	unsigned long long normalCacheHits;		// randStdNorm ( ) calls answered from the cached second value
+	unsigned long long invalidZeroReturns;	// values returned as 0 because the generator is invalid
+
+	ICGStats ( )
+	: randCalls ( 0 ), inversions ( 0 ), euclidIterations ( 0 ), normalRejections ( 0 ), normalCacheHits ( 0 ), invalidZeroReturns ( 0 )
+	{
+	}
+
+	/**
+	 * Adds the counters of another snapshot.
+	 *
+	 * @param other The snapshot to add.
+	 * @return This snapshot.
+	 */
+	ICGStats & operator += ( const ICGStats & other ) {
+		randCalls += other.randCalls;
+		inversions += other.inversions;
+		euclidIterations += other.euclidIterations;
+		normalRejections += other.normalRejections;
+		normalCacheHits += other.normalCacheHits;
+		invalidZeroReturns += other.invalidZeroReturns;
+		return *this;
+	}
+
+	std :: string toPrometheus ( const std :: string & labels = "" ) const;
+};
+
+#endif /* __ICGSTATS_H__ */
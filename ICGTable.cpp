@@ -0,0 +1,420 @@
+#include "ICGTable.h"
+#include "ICG.h"
+#include <errno.h> // using: errno, EINTR
+#include <fcntl.h> // using: open ( )
+#include <math.h> // using: exp ( ), log ( ), expm1 ( ), log1p ( ), fabs ( )
+#include <string.h> // using: memcpy ( )
+#include <unistd.h> // using: pwrite ( ), close ( )
+#include <atomic> // using: std::atomic
+#include <thread> // using: std::thread
+
+namespace {
+
+const char MAGIC [ 8 ] = { 'I', 'C', 'G', 'T', 'A', 'B', 'L', 'E' };
+const unsigned VERSION = 1;
+const size_t HEADER_SIZE = 16;
+const size_t CHUNK_ALIGN = 64;
+
+void putLE ( std :: vector < unsigned char > & out, unsigned long long value, int bytes ) {
+	for ( int i = 0; i < bytes; i++ ) out.push_back ( ( unsigned char ) ( value >> ( 8 * i ) ) );
+}
+
+void putDouble ( std :: vector < unsigned char > & out, double value ) {
+	unsigned long long bits;
+	memcpy ( &bits, &value, sizeof ( bits ) );
+	putLE ( out, bits, 8 );
+}
+
+void putString ( std :: vector < unsigned char > & out, const std :: string & s ) {
+	putLE ( out, s.size ( ), 4 );
+	out.insert ( out.end ( ), s.begin ( ), s.end ( ) );
+}
+
+bool pwriteAll ( int fd, const void * data, size_t bytes, unsigned long long offset ) {
+	const char * p = ( const char * ) data;
+	while ( bytes > 0 ) {
+		ssize_t written = pwrite ( fd, p, bytes, ( off_t ) offset );
+		if ( written < 0 ) {
+			if ( errno == EINTR ) continue;
+			return false;
+		}
+		p += written;
+		bytes -= written;
+		offset += written;
+	}
+	return true;
+}
+
+// Helpers of the rejection-inversion Zipf sampler (Hoermann and Derflinger, 1996):
+// helper1 ( x ) = log1p ( x ) / x and helper2 ( x ) = expm1 ( x ) / x, with series near 0.
+double helper1 ( double x ) {
+	return ( fabs ( x ) > 1e-8 ) ? log1p ( x ) / x : 1.0 - x * ( 0.5 - x * ( 1.0 / 3.0 - 0.25 * x ) );
+}
+
+double helper2 ( double x ) {
+	return ( fabs ( x ) > 1e-8 ) ? expm1 ( x ) / x : 1.0 + x * 0.5 * ( 1.0 + x * ( 1.0 / 3.0 ) * ( 1.0 + 0.25 * x ) );
+}
+
+// H ( x ), an integral of h ( x ) = x^-s, and its inverse
+double hIntegral ( double x, double s ) {
+	double logX = log ( x );
+	return helper2 ( ( 1.0 - s ) * logX ) * logX;
+}
+
+double h ( double x, double s ) { return exp ( -s * log ( x ) ); }
+
+double hIntegralInverse ( double x, double s ) {
+	double t = x * ( 1.0 - s );
+	if ( t < -1.0 ) t = -1.0;
+	return exp ( helper1 ( t ) * x );
+}
+
+} // namespace
+
+
+/**
+ * Creates a table description without columns.
+ *
+ * @param p The generator's prime.
+ * @param a The generator's parameter a.
+ * @param b The generator's parameter b.
+ * @param seed The generator's seed.
+ */
+ICGTable :: ICGTable ( unsigned long p, unsigned long a, unsigned long b, unsigned long seed )
+: p ( p ), a ( a ), b ( b ), seed ( seed ), groupRows ( DEFAULT_ROW_GROUP_ROWS )
+{
+}
+
+
+/**
+ * Adds a column of int64 values uniformly distributed in lo, lo+1, ..., hi.
+ *
+ * @param name The column name.
+ * @param lo The smallest value.
+ * @param hi The largest value.
+ * @return False if hi < lo; no column is added then.
+ */
+bool ICGTable :: addUniformInt ( const std :: string & name, long long lo, long long hi ) {
+	if ( hi < lo ) return false;
+	Column c = Column ( );
+	c.name = name;
+	c.type = UNIFORM_INT;
+	c.lo = lo;
+	c.hi = hi;
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Adds a column of doubles uniformly distributed in [ lo, hi ).
+ *
+ * @param name The column name.
+ * @param lo The lower bound.
+ * @param hi The upper bound.
+ * @return False if hi < lo; no column is added then.
+ */
+bool ICGTable :: addInterval ( const std :: string & name, double lo, double hi ) {
+	if ( !( lo <= hi ) ) return false;
+	Column c = Column ( );
+	c.name = name;
+	c.type = INTERVAL;
+	c.x = lo;
+	c.y = hi;
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Adds a column of normally distributed doubles.
+ *
+ * @param name The column name.
+ * @param mu The mean.
+ * @param sigma The standard deviation.
+ * @return False if sigma < 0; no column is added then.
+ */
+bool ICGTable :: addNormal ( const std :: string & name, double mu, double sigma ) {
+	if ( !( sigma >= 0.0 ) ) return false;
+	Column c = Column ( );
+	c.name = name;
+	c.type = NORMAL;
+	c.x = mu;
+	c.y = sigma;
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Adds a column of Zipf distributed int64 ranks: P ( k ) is proportional to k^-s for k = 1, ..., n.
+ *
+ * Uses rejection-inversion sampling, which takes O ( 1 ) expected time and no tables for any n.
+ *
+ * @param name The column name.
+ * @param n The number of ranks, at least 1.
+ * @param s The exponent, > 0.
+ * @return False for invalid n or s; no column is added then.
+ */
+bool ICGTable :: addZipf ( const std :: string & name, long long n, double s ) {
+	if ( n < 1 || !( s > 0.0 ) ) return false;
+	Column c = Column ( );
+	c.name = name;
+	c.type = ZIPF;
+	c.lo = 1;
+	c.hi = n;
+	c.x = s;
+	c.hIntegralX1 = hIntegral ( 1.5, s ) - 1.0;
+	c.hIntegralN = hIntegral ( n + 0.5, s );
+	c.zipfS = 2.0 - hIntegralInverse ( hIntegral ( 2.5, s ) - h ( 2.0, s ), s );
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Adds a column of category indices drawn with the given weights.
+ *
+ * The values are int32 indices into categories; the category names are stored in the footer.
+ *
+ * @param name The column name.
+ * @param categories The category names.
+ * @param weights Non-negative weights, one per category, not all 0. They need not sum to 1.
+ * @return False if the lists are empty, differ in length or the weights are invalid; no column is added then.
+ */
+bool ICGTable :: addCategorical ( const std :: string & name, const std :: vector < std :: string > & categories,
+								  const std :: vector < double > & weights ) {
+	const size_t k = categories.size ( );
+	if ( k == 0 || k != weights.size ( ) || k > 0x7FFFFFFF ) return false;
+	double total = 0.0;
+	for ( size_t i = 0; i < k; i++ ) {
+		if ( !( weights [ i ] >= 0.0 ) ) return false;
+		total += weights [ i ];
+	}
+	if ( !( total > 0.0 ) ) return false;
+
+	Column c = Column ( );
+	c.name = name;
+	c.type = CATEGORICAL;
+	c.categories = categories;
+	c.weights = weights;
+
+	// Vose's alias method: column i keeps probability aliasProb [ i ], the rest goes to alias [ i ]
+	c.aliasProb.resize ( k );
+	c.alias.resize ( k );
+	std :: vector < double > scaled ( k );
+	std :: vector < unsigned > small, large;
+	for ( size_t i = 0; i < k; i++ ) {
+		scaled [ i ] = weights [ i ] * k / total;
+		( scaled [ i ] < 1.0 ? small : large ).push_back ( ( unsigned ) i );
+	}
+	while ( !small.empty ( ) && !large.empty ( ) ) {
+		unsigned s = small.back ( ), l = large.back ( );
+		small.pop_back ( );
+		c.aliasProb [ s ] = scaled [ s ];
+		c.alias [ s ] = l;
+		scaled [ l ] -= 1.0 - scaled [ s ];
+		if ( scaled [ l ] < 1.0 ) {
+			large.pop_back ( );
+			small.push_back ( l );
+		}
+	}
+	// whatever remains is 1 up to rounding
+	for ( size_t i = 0; i < small.size ( ); i++ ) { c.aliasProb [ small [ i ] ] = 1.0; c.alias [ small [ i ] ] = small [ i ]; }
+	for ( size_t i = 0; i < large.size ( ); i++ ) { c.aliasProb [ large [ i ] ] = 1.0; c.alias [ large [ i ] ] = large [ i ]; }
+
+	cols.push_back ( c );
+	return true;
+}
+
+
+/**
+ * Returns the size of a stored value.
+ *
+ * @param type A column type.
+ * @return 4 for CATEGORICAL, 8 otherwise.
+ */
+size_t ICGTable :: valueSize ( ColumnType type ) {
+	return ( type == CATEGORICAL ) ? 4 : 8;
+}
+
+
+/**
+ * Generates one column chunk.
+ *
+ * Exposed so tables can also be generated into memory, chunk by chunk, without a file.
+ *
+ * @param group The row group.
+ * @param column The column index.
+ * @param rows The total number of rows of the table, which determines the number of row groups.
+ * @param out Receives the values of the chunk: min ( groupRows, rows - group * groupRows ) values of
+ *            valueSize ( type ) bytes.
+ */
+void ICGTable :: generateChunk ( unsigned long long group, size_t column, unsigned long long rows, void * out ) const {
+	const unsigned long long groups = ( rows + groupRows - 1 ) / groupRows;
+	if ( group >= groups || column >= cols.size ( ) ) return;
+
+	const unsigned long long first = group * groupRows;
+	const size_t n = ( size_t ) ( ( rows - first < groupRows ) ? rows - first : groupRows );
+	const unsigned long long substreams = groups * cols.size ( );
+
+	ICG gen ( p, a, b, seed );
+	gen.jump ( ( group * cols.size ( ) + column ) * ( p / substreams ) );
+
+	const Column & col = cols [ column ];
+	switch ( col.type ) {
+		case UNIFORM_INT: {
+			long long * v = ( long long * ) out;
+			unsigned long long range = ( unsigned long long ) col.hi - ( unsigned long long ) col.lo + 1;
+			for ( size_t i = 0; i < n; i++ ) {
+				unsigned long long r = range ? gen.randBounded ( ( unsigned long ) range ) : gen.rand64 ( );
+				v [ i ] = ( long long ) ( ( unsigned long long ) col.lo + r );
+			}
+			break;
+		}
+		case INTERVAL: {
+			double * v = ( double * ) out;
+			gen.fill01 ( v, n );
+			for ( size_t i = 0; i < n; i++ ) v [ i ] = col.x + ( col.y - col.x ) * v [ i ];
+			break;
+		}
+		case NORMAL: {
+			double * v = ( double * ) out;
+			for ( size_t i = 0; i < n; i++ ) v [ i ] = col.x + col.y * gen.randStdNorm ( );
+			break;
+		}
+		case ZIPF: {
+			long long * v = ( long long * ) out;
+			const double s = col.x;
+			for ( size_t i = 0; i < n; i++ ) {
+				for ( ;; ) {
+					double u = col.hIntegralN + gen.rand01 ( ) * ( col.hIntegralX1 - col.hIntegralN );
+					double x = hIntegralInverse ( u, s );
+					long long k = ( long long ) ( x + 0.5 );
+					if ( k < 1 ) k = 1;
+					else if ( k > col.hi ) k = col.hi;
+					if ( k - x <= col.zipfS || u >= hIntegral ( k + 0.5, s ) - h ( ( double ) k, s ) ) {
+						v [ i ] = k;
+						break;
+					}
+				}
+			}
+			break;
+		}
+		case CATEGORICAL: {
+			int * v = ( int * ) out;
+			const unsigned long k = ( unsigned long ) col.categories.size ( );
+			for ( size_t i = 0; i < n; i++ ) {
+				unsigned long j = gen.randBounded ( k );
+				v [ i ] = ( int ) ( gen.rand01 ( ) < col.aliasProb [ j ] ? j : col.alias [ j ] );
+			}
+			break;
+		}
+	}
+}
+
+
+/**
+ * Encodes the footer.
+ *
+ * Private helper method.
+ * Layout (little-endian): rows (u64), row group rows (u64), p, a, b, seed (u64 each), number of columns (u32),
+ * then per column: type (u32), name (u32 length and bytes), four parameters (lo and hi as i64, x and y as f64),
+ * number of categories (u32) and per category its name (u32 length and bytes) and weight (f64);
+ * finally the file offset of every column chunk (u64), row group by row group.
+ */
+std :: vector < unsigned char > ICGTable :: footer ( unsigned long long rows, const std :: vector < unsigned long long > & offsets ) const {
+	std :: vector < unsigned char > out;
+	putLE ( out, rows, 8 );
+	putLE ( out, groupRows, 8 );
+	putLE ( out, p, 8 );
+	putLE ( out, a, 8 );
+	putLE ( out, b, 8 );
+	putLE ( out, seed, 8 );
+	putLE ( out, cols.size ( ), 4 );
+	for ( size_t c = 0; c < cols.size ( ); c++ ) {
+		const Column & col = cols [ c ];
+		putLE ( out, col.type, 4 );
+		putString ( out, col.name );
+		putLE ( out, ( unsigned long long ) col.lo, 8 );
+		putLE ( out, ( unsigned long long ) col.hi, 8 );
+		putDouble ( out, col.x );
+		putDouble ( out, col.y );
+		putLE ( out, col.categories.size ( ), 4 );
+		for ( size_t i = 0; i < col.categories.size ( ); i++ ) {
+			putString ( out, col.categories [ i ] );
+			putDouble ( out, col.weights [ i ] );
+		}
+	}
+	for ( size_t i = 0; i < offsets.size ( ); i++ ) putLE ( out, offsets [ i ], 8 );
+	return out;
+}
+
+
+/**
+ * Generates the table into a file.
+ *
+ * The chunk offsets are computed up front; the threads then take column chunks in file order, generate
+ * each into a reused buffer and write it with pwrite ( ) at its offset.
+ *
+ * @param path The file to write, created or truncated.
+ * @param rows The number of rows.
+ * @param threads The number of threads, 0 for one per hardware thread.
+ * @return True iff the file has been written. False for an invalid generator, no columns or I/O errors.
+ */
+bool ICGTable :: write ( const char * path, unsigned long long rows, unsigned threads ) const {
+	if ( cols.empty ( ) || !ICG ( p, a, b, seed ).isValid ( ) ) return false;
+	if ( threads == 0 ) threads = std :: thread :: hardware_concurrency ( );
+	if ( threads == 0 ) threads = 1;
+
+	const unsigned long long groups = ( rows + groupRows - 1 ) / groupRows;
+	const size_t C = cols.size ( );
+
+	std :: vector < unsigned long long > offsets ( groups * C );
+	unsigned long long pos = HEADER_SIZE;
+	for ( unsigned long long g = 0; g < groups; g++ ) {
+		unsigned long long n = ( rows - g * groupRows < groupRows ) ? rows - g * groupRows : groupRows;
+		for ( size_t c = 0; c < C; c++ ) {
+			pos = ( pos + CHUNK_ALIGN - 1 ) / CHUNK_ALIGN * CHUNK_ALIGN;
+			offsets [ g * C + c ] = pos;
+			pos += n * valueSize ( cols [ c ].type );
+		}
+	}
+
+	int fd = open ( path, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if ( fd < 0 ) return false;
+
+	std :: vector < unsigned char > header ( MAGIC, MAGIC + 8 );
+	putLE ( header, VERSION, 4 );
+	unsigned bom = 0x01020304;
+	header.insert ( header.end ( ), ( unsigned char * ) &bom, ( unsigned char * ) &bom + 4 );
+	std :: atomic < bool > ok ( pwriteAll ( fd, header.data ( ), header.size ( ), 0 ) );
+
+	std :: atomic < unsigned long long > next ( 0 );
+	std :: vector < std :: thread > workers;
+	for ( unsigned t = 0; t < threads; t++ ) {
+		workers.push_back ( std :: thread ( [ & ] ( ) {
+			std :: vector < unsigned long long > buffer;	// 8 byte aligned for any value type
+			for ( unsigned long long i; ( i = next++ ) < groups * C; ) {
+				unsigned long long g = i / C;
+				size_t c = ( size_t ) ( i % C );
+				unsigned long long n = ( rows - g * groupRows < groupRows ) ? rows - g * groupRows : groupRows;
+				size_t bytes = ( size_t ) n * valueSize ( cols [ c ].type );
+				buffer.resize ( ( bytes + 7 ) / 8 );
+				generateChunk ( g, c, rows, buffer.data ( ) );
+				if ( !pwriteAll ( fd, buffer.data ( ), bytes, offsets [ i ] ) ) ok = false;
+			}
+		} ) );
+	}
+	for ( unsigned t = 0; t < threads; t++ ) workers [ t ].join ( );
+
+	std :: vector < unsigned char > tail = footer ( rows, offsets );
+	unsigned long long footerSize = tail.size ( );
+	putLE ( tail, pos, 8 );
+	putLE ( tail, footerSize, 8 );
+	tail.insert ( tail.end ( ), MAGIC, MAGIC + 8 );
+	if ( !pwriteAll ( fd, tail.data ( ), tail.size ( ), pos ) ) ok = false;
+
+	if ( close ( fd ) != 0 ) ok = false;
+	return ok;
+}
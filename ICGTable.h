@@ -0,0 +1,114 @@
+#ifndef __ICGTABLE_H__
+#define __ICGTABLE_H__
+
+#include <stddef.h> // using: size_t
+#include <string> // using: std::string
+#include <vector> // using: std::vector
+
+/**
+ * Columnar synthetic tables.
+ *
+ * A table is described by a schema, a list of columns each with a distribution, and written with write ( )
+ * as a column-major binary file. The rows are split into row groups; within a row group the values of
+ * each column are stored contiguously (a column chunk), as in Parquet or Arrow record batches.
+ *
+ * Every column chunk draws from its own ICG substream: chunk ( g, c ) of G row groups and C columns
+ * continues the generator sequence from ICG :: jump ( ( g * C + c ) * ( p / ( G * C ) ) ). Chunks are
+ * therefore generated independently and in parallel, and since all values have a fixed size, the file
+ * offset of every chunk is known in advance. A table only depends on its schema, the generator
+ * parameters, the row count and the row group size, so it can be regenerated identically anywhere.
+ * The substreams are disjoint while rows * C < p; tables of 10^10 rows need a prime of more than
+ * 40 bits, e.g. 2^61 - 1.
+ *
+ * Column types and their stored values:
+ *
+ *  - UNIFORM_INT:  int64, uniform in lo, ..., hi
+ *  - INTERVAL:     double, uniform in [ lo, hi )
+ *  - NORMAL:       double, normal with mean mu and standard deviation sigma
+ *  - ZIPF:         int64 in 1, ..., n with P ( k ) proportional to k^-s (rejection-inversion sampling)
+ *  - CATEGORICAL:  int32 index into the category list, picked with the given weights (alias method)
+ *
+ * File layout:
+ *
+ * 	header   16 bytes: magic "ICGTABLE", format version (u32, 1), byte order mark (u32 0x01020304)
+ * 	chunks   for each row group, for each column: the values in native byte order,
+ * 	         each chunk starting at a multiple of 64 bytes
+ * 	footer   the schema and generator parameters, see write ( )
+ * 	trailer  24 bytes: footer offset (u64), footer size (u64), magic "ICGTABLE"
+ *
+ * The header, footer and trailer are little-endian; the byte order mark tells readers in which order
+ * the values were stored.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGTable.h"
+ *
+ * 	...
+ *
+ * 	ICGTable table ( 2305843009213693951UL, 1234567, 1, 12345 );
+ * 	table.addUniformInt ( "customer", 1, 1000000 );
+ * 	table.addZipf ( "product", 50000, 1.1 );
+ * 	table.addInterval ( "price", 1.0, 500.0 );
+ * 	table.addCategorical ( "region", { "north", "south", "east", "west" }, { 0.4, 0.3, 0.2, 0.1 } );
+ * 	table.write ( "sales.tbl", 10000000000ULL );
+ *
+ */
+class ICGTable {
+	public:
+		enum ColumnType { UNIFORM_INT = 1, INTERVAL = 2, NORMAL = 3, ZIPF = 4, CATEGORICAL = 5 };
+
+		struct Column {
+			std :: string name;
+			ColumnType type;
+			long long lo, hi;		// UNIFORM_INT: inclusive bounds; ZIPF: 1 and n
+			double x, y;			// INTERVAL: [ x, y ); NORMAL: mean x, standard deviation y; ZIPF: exponent x
+			std :: vector < std :: string > categories;
+			std :: vector < double > weights;
+
+			// sampling tables: alias method for CATEGORICAL, rejection-inversion constants for ZIPF
+			std :: vector < double > aliasProb;
+			std :: vector < unsigned > alias;
+			double hIntegralX1, hIntegralN, zipfS;
+		};
+
+		static const unsigned long long DEFAULT_ROW_GROUP_ROWS = 1 << 20;
+
+		ICGTable ( unsigned long p, unsigned long a, unsigned long b, unsigned long seed );
+
+		bool addUniformInt ( const std :: string & name, long long lo, long long hi );
+		bool addInterval ( const std :: string & name, double lo, double hi );
+		bool addNormal ( const std :: string & name, double mu, double sigma );
+		bool addZipf ( const std :: string & name, long long n, double s );
+		bool addCategorical ( const std :: string & name, const std :: vector < std :: string > & categories,
+							  const std :: vector < double > & weights );
+
+		/**
+		 * Returns the schema.
+		 *
+		 * @return The columns in storage order.
+		 */
+		const std :: vector < Column > & columns ( ) const { return cols; }
+
+		/**
+		 * Sets the number of rows per row group.
+		 *
+		 * @param rows Rows per row group, at least 1.
+		 */
+		void setRowGroupRows ( unsigned long long rows ) { groupRows = rows ? rows : 1; }
+
+		static size_t valueSize ( ColumnType type );
+
+		void generateChunk ( unsigned long long group, size_t column, unsigned long long rows, void * out ) const;
+		bool write ( const char * path, unsigned long long rows, unsigned threads = 0 ) const;
+
+	private:
+		unsigned long p, a, b, seed;
+		std :: vector < Column > cols;
+		unsigned long long groupRows;
+
+		std :: vector < unsigned char > footer ( unsigned long long rows, const std :: vector < unsigned long long > & offsets ) const;
+};
+
+#endif /* __ICGTABLE_H__ */
@@ -0,0 +1,276 @@
+#include "ICGTape.h"
+#include "ICG.h"
+#include <fcntl.h> // using: open ( )
+#include <string.h> // using: memcpy ( ), memcmp ( ), memset ( )
+#include <sys/mman.h> // using: mmap ( ), munmap ( ), MAP_POPULATE
+#include <sys/stat.h> // using: fstat ( )
+#include <unistd.h> // using: ftruncate ( ), close ( )
+#include <atomic> // using: std::atomic
+#include <thread> // using: std::thread
+#include <vector> // using: std::vector
+
+namespace {
+
+const unsigned char MAGIC [ 8 ] = { 'I', 'C', 'G', 'T', 'A', 'P', 'E', 0 };
+const unsigned VERSION = 1;
+
+void putLE ( unsigned char * out, unsigned long long value, int bytes ) {
+	for ( int i = 0; i < bytes; i++ ) out [ i ] = ( unsigned char ) ( value >> ( 8 * i ) );
+}
+
+unsigned long long getLE ( const unsigned char * in, int bytes ) {
+	unsigned long long value = 0;
+	for ( int i = bytes - 1; i >= 0; i-- ) value = ( value << 8 ) | in [ i ];
+	return value;
+}
+
+size_t valueSize ( unsigned type ) { return ( type == ICGTape :: U32 ) ? 4 : 8; }
+
+size_t paddedDataSize ( unsigned long long count, unsigned type ) { return ( size_t ) ( ( count * valueSize ( type ) + 7 ) / 8 * 8 ); }
+
+unsigned defaultThreads ( unsigned threads ) {
+	if ( threads == 0 ) threads = std :: thread :: hardware_concurrency ( );
+	return threads ? threads : 1;
+}
+
+} // namespace
+
+
+/**
+ * Generates a tape file.
+ *
+ * The file is created (or truncated) with its final size and mapped; the threads fill the segments in
+ * place, then the checksum and the header are written.
+ *
+ * @param path The file to write.
+ * @param p The generator's prime.
+ * @param a The generator's parameter a.
+ * @param b The generator's parameter b.
+ * @param seed The generator's seed.
+ * @param offset The number of jump ( ) steps from the seed to the start of the tape.
+ * @param type The type of the values.
+ * @param count The number of values.
+ * @param threads The number of threads, 0 for one per hardware thread.
+ * @param segments The number of independently generated segments, at least 1 and at most p.
+ * @return True iff the tape has been written. False for invalid generator parameters, more segments
+ *         than p (their stride p / segments would be 0, so all segments would repeat the same values)
+ *         or I/O errors.
+ */
+bool ICGTape :: create ( const char * path, unsigned long p, unsigned long a, unsigned long b, unsigned long seed,
+						 unsigned long long offset, ValueType type, unsigned long long count,
+						 unsigned threads, unsigned segments ) {
+	if ( type != U32 && type != DOUBLE && type != NORMAL ) return false;
+	if ( segments == 0 ) segments = 1;
+	threads = defaultThreads ( threads );
+
+	ICG config ( p, a, b, seed );
+	if ( !config.isValid ( ) || segments > p ) return false;
+
+	const size_t dataSize = paddedDataSize ( count, type );
+	const size_t fileSize = HEADER_SIZE + dataSize;
+
+	int fd = ::open ( path, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+	if ( fd < 0 ) return false;
+	if ( ftruncate ( fd, ( off_t ) fileSize ) != 0 ) {
+		::close ( fd );
+		return false;
+	}
+	void * mem = mmap ( 0, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	::close ( fd );
+	if ( mem == MAP_FAILED ) return false;
+	unsigned char * file = ( unsigned char * ) mem;
+	unsigned char * data = file + HEADER_SIZE;
+
+	// segments are handed out dynamically, so normals (which take a variable number of steps) balance out
+	std :: atomic < unsigned > nextSegment ( 0 );
+	std :: vector < std :: thread > workers;
+	for ( unsigned t = 0; t < threads; t++ ) {
+		workers.push_back ( std :: thread ( [ & ] ( ) {
+			for ( unsigned j; ( j = nextSegment++ ) < segments; ) {
+				unsigned long long first = count / segments * j + count % segments * j / segments;
+				unsigned long long last = count / segments * ( j + 1 ) + count % segments * ( j + 1 ) / segments;
+
+				ICG gen ( p, a, b, seed );
+				gen.jump ( offset + ( unsigned long long ) j * ( p / segments ) );
+
+				if ( type == U32 ) {
+					gen.fillBytes ( data + first * 4, ( size_t ) ( last - first ) * 4 );
+				} else if ( type == DOUBLE ) {
+					gen.fill01 ( ( double * ) data + first, ( size_t ) ( last - first ) );
+				} else {
+					double * out = ( double * ) data + first;
+					for ( unsigned long long i = 0; i < last - first; i++ ) out [ i ] = gen.randStdNorm ( );
+				}
+			}
+		} ) );
+	}
+	for ( unsigned t = 0; t < threads; t++ ) workers [ t ].join ( );
+
+	unsigned char * header = file;
+	memset ( header, 0, HEADER_SIZE );
+	memcpy ( header, MAGIC, 8 );
+	putLE ( header + 8, VERSION, 4 );
+	putLE ( header + 12, type, 4 );
+	putLE ( header + 16, valueSize ( type ), 4 );
+	putLE ( header + 20, segments, 4 );
+	putLE ( header + 24, p, 8 );
+	putLE ( header + 32, a, 8 );
+	putLE ( header + 40, b, 8 );
+	putLE ( header + 48, seed, 8 );
+	putLE ( header + 56, offset, 8 );
+	putLE ( header + 64, count, 8 );
+	putLE ( header + 72, computeChecksum ( data, dataSize, threads ), 8 );
+
+	bool ok = msync ( file, fileSize, MS_SYNC ) == 0;
+	munmap ( file, fileSize );
+	return ok;
+}
+
+
+/**
+ * Creates an object with no tape open.
+ */
+ICGTape :: ICGTape ( )
+: base ( 0 ), mappedSize ( 0 ), type ( U32 ), p ( 0 ), a ( 0 ), b ( 0 ), seed ( 0 ), offset ( 0 ), numValues ( 0 ), checksum ( 0 ), segments ( 0 )
+{
+}
+
+
+/**
+ * Unmaps the tape, if one is open.
+ */
+ICGTape :: ~ICGTape ( ) {
+	close ( );
+}
+
+
+/**
+ * Maps a tape file read-only.
+ *
+ * The header is checked for the magic number, the format version and a file size that fits the count;
+ * the checksum is only checked by verify ( ), which has to read the whole tape.
+ *
+ * @param path The tape file.
+ * @return True iff the file is a tape and could be mapped.
+ */
+bool ICGTape :: open ( const char * path ) {
+	close ( );
+
+	int fd = ::open ( path, O_RDONLY );
+	if ( fd < 0 ) return false;
+	struct stat st;
+	if ( fstat ( fd, &st ) != 0 || ( size_t ) st.st_size < HEADER_SIZE ) {
+		::close ( fd );
+		return false;
+	}
+
+	size_t size = ( size_t ) st.st_size;
+	int flags = MAP_PRIVATE;
+#if defined ( MAP_POPULATE )
+	flags |= MAP_POPULATE;	// fault in the whole tape now instead of during the replay
+#endif
+	void * mem = mmap ( 0, size, PROT_READ, flags, fd, 0 );
+	::close ( fd );
+	if ( mem == MAP_FAILED ) return false;
+
+	const unsigned char * header = ( const unsigned char * ) mem;
+	unsigned t = ( unsigned ) getLE ( header + 12, 4 );
+	unsigned long long n = getLE ( header + 64, 8 );
+	bool ok = memcmp ( header, MAGIC, 8 ) == 0
+			  && getLE ( header + 8, 4 ) == VERSION
+			  && ( t == U32 || t == DOUBLE || t == NORMAL )
+			  && getLE ( header + 16, 4 ) == valueSize ( t )
+			  && n <= ( size - HEADER_SIZE ) / valueSize ( t )
+			  && size == HEADER_SIZE + paddedDataSize ( n, t );
+	if ( !ok ) {
+		munmap ( mem, size );
+		return false;
+	}
+
+	base = header;
+	mappedSize = size;
+	type = ( ValueType ) t;
+	segments = ( unsigned ) getLE ( header + 20, 4 );
+	p = ( unsigned long ) getLE ( header + 24, 8 );
+	a = ( unsigned long ) getLE ( header + 32, 8 );
+	b = ( unsigned long ) getLE ( header + 40, 8 );
+	seed = ( unsigned long ) getLE ( header + 48, 8 );
+	offset = getLE ( header + 56, 8 );
+	numValues = n;
+	checksum = getLE ( header + 72, 8 );
+	return true;
+}
+
+
+/**
+ * Unmaps the tape. Pointers obtained from u32 ( ) or doubles ( ) become invalid.
+ */
+void ICGTape :: close ( ) {
+	if ( base ) munmap ( ( void * ) base, mappedSize );
+	base = 0;
+	mappedSize = 0;
+}
+
+
+/**
+ * Checks that the open tape was generated with the given configuration.
+ *
+ * The segments are part of the configuration, since they determine where the substreams start.
+ *
+ * @return True iff a tape is open and its header has exactly these parameters.
+ */
+bool ICGTape :: matches ( unsigned long p, unsigned long a, unsigned long b, unsigned long seed,
+						  unsigned long long offset, ValueType type, unsigned segments ) const {
+	return base && this -> p == p && this -> a == a && this -> b == b && this -> seed == seed
+		   && this -> offset == offset && this -> type == type && this -> segments == segments;
+}
+
+
+/**
+ * Recomputes the checksum of the open tape, reading it with all cores.
+ *
+ * @return True iff a tape is open and its data matches the checksum in its header.
+ */
+bool ICGTape :: verify ( ) const {
+	if ( !base ) return false;
+	return computeChecksum ( base + HEADER_SIZE, mappedSize - HEADER_SIZE, defaultThreads ( 0 ) ) == checksum;
+}
+
+
+/**
+ * Checksum of the data area: the sum of a mixing function of each 64 bit word and its index.
+ *
+ * Private helper method.
+ * A sum can be computed in parallel pieces, and including the index makes it sensitive to reordering.
+ *
+ * @param data The data area, a multiple of 8 bytes long.
+ * @param bytes The size of the data area.
+ * @param threads The number of threads to use.
+ * @return The checksum.
+ */
+unsigned long long ICGTape :: computeChecksum ( const unsigned char * data, size_t bytes, unsigned threads ) {
+	const size_t words = bytes / 8;
+	std :: vector < unsigned long long > partial ( threads, 0 );
+	std :: vector < std :: thread > workers;
+
+	for ( unsigned t = 0; t < threads; t++ ) {
+		workers.push_back ( std :: thread ( [ &, t ] ( ) {
+			unsigned long long sum = 0;
+			for ( size_t i = words / threads * t; i < ( t + 1 == threads ? words : words / threads * ( t + 1 ) ); i++ ) {
+				// splitmix64 finalizer of the word combined with its index
+				unsigned long long z = getLE ( data + 8 * i, 8 ) ^ ( i * 0x9E3779B97F4A7C15ULL );
+				z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+				z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+				sum += z ^ ( z >> 31 );
+			}
+			partial [ t ] = sum;
+		} ) );
+	}
+
+	unsigned long long sum = 0;
+	for ( unsigned t = 0; t < threads; t++ ) {
+		workers [ t ].join ( );
+		sum += partial [ t ];
+	}
+	return sum;
+}
@@ -0,0 +1,175 @@
+#ifndef __ICGTAPE_H__
+#define __ICGTAPE_H__
+
+#include <stddef.h> // using: size_t
+
+/**
+ * Pre-generated random tapes.
+ *
+ * A tape is a file holding count values of one type generated by an ICG, behind a 128 byte header with
+ * the generator parameters, seed, offset, value type and a checksum. create ( ) generates a tape with
+ * all cores, writing directly into a shared mapping of the file; open ( ) maps an existing tape read-only
+ * (prefaulted with MAP_POPULATE where available), so benchmark and regression runs can replay an
+ * identical stream at memory speed. matches ( ) checks that a tape was made with the expected
+ * configuration, verify ( ) recomputes its checksum.
+ *
+ * The values are split into segments which are generated independently: segment j holds values
+ * j * count / segments, ..., ( j + 1 ) * count / segments - 1, continuing the sequence from
+ * ICG :: jump ( offset + j * ( p / segments ) ), so there are at most p segments. The content only
+ * depends on the header fields, including the segments, not on the number of threads.
+ *
+ * File layout (all header fields little-endian):
+ *
+ * 	offset  size
+ * 	     0     8  magic "ICGTAPE\0"
+ * 	     8     4  format version (1)
+ * 	    12     4  value type (1: u32, 2: double from rand01 ( ), 3: double from randStdNorm ( ))
+ * 	    16     4  value size in bytes
+ * 	    20     4  segments
+ * 	    24     8  p
+ * 	    32     8  a
+ * 	    40     8  b
+ * 	    48     8  seed
+ * 	    56     8  offset
+ * 	    64     8  count
+ * 	    72     8  checksum of the data
+ * 	    80    48  reserved, zero
+ * 	   128        count values in native byte order, zero padded to a multiple of 8 bytes
+ *
+ * The checksum detects damaged or truncated files; it is not a cryptographic hash.
+ * Tapes use POSIX mmap ( ), so this module is not available on other platforms.
+ */
+
+/*
+ * Usage example:
+ *
+ * 	#include "ICGTape.h"
+ *
+ * 	...
+ *
+ * 	// once: 10^9 uniforms from the sequence starting at seed 12345
+ * 	ICGTape :: create ( "uniforms.tape", 2147483647, 16807, 1, 12345, 0, ICGTape :: DOUBLE, 1000000000ULL );
+ *
+ * 	// every run
+ * 	ICGTape tape;
+ * 	if ( tape.open ( "uniforms.tape" ) && tape.matches ( 2147483647, 16807, 1, 12345, 0, ICGTape :: DOUBLE ) ) {
+ * 		const double * u = tape.doubles ( );
+ * 		for ( unsigned long long i = 0; i < tape.count ( ); i++ ) use ( u [ i ] );
+ * 	}
+ *
+ */
+class ICGTape {
+	public:
+		enum ValueType { U32 = 1, DOUBLE = 2, NORMAL = 3 };
+
+		static const size_t HEADER_SIZE = 128;
+		static const unsigned DEFAULT_SEGMENTS = 64;
+
+		static bool create ( const char * path, unsigned long p, unsigned long a, unsigned long b, unsigned long seed,
+							 unsigned long long offset, ValueType type, unsigned long long count,
+							 unsigned threads = 0, unsigned segments = DEFAULT_SEGMENTS );
+
+		ICGTape ( );
+		~ICGTape ( );
+
+		bool open ( const char * path );
+		void close ( );
+
+		bool matches ( unsigned long p, unsigned long a, unsigned long b, unsigned long seed,
+					   unsigned long long offset, ValueType type, unsigned segments = DEFAULT_SEGMENTS ) const;
+		bool verify ( ) const;
+
+		/**
+		 * Returns whether a tape is open.
+		 *
+		 * @return True iff open ( ) succeeded and close ( ) has not been called since.
+		 */
+		bool isValid ( ) const { return base != 0; }
+
+		/**
+		 * Returns the values of a u32 tape.
+		 *
+		 * @return count ( ) 32 bit words, or 0 if no u32 tape is open.
+		 */
+		const unsigned int * u32 ( ) const { return ( base && type == U32 ) ? ( const unsigned int * ) ( base + HEADER_SIZE ) : 0; }
+
+		/**
+		 * Returns the values of a double or normal tape.
+		 *
+		 * @return count ( ) doubles, or 0 if no such tape is open.
+		 */
+		const double * doubles ( ) const { return ( base && type != U32 ) ? ( const double * ) ( base + HEADER_SIZE ) : 0; }
+
+		/**
+		 * Returns the number of values on the tape.
+		 *
+		 * @return The count field of the header, 0 if no tape is open.
+		 */
+		unsigned long long count ( ) const { return base ? numValues : 0; }
+
+		/**
+		 * Returns the type of the values on the tape.
+		 *
+		 * @return The value type.
+		 */
+		ValueType get_type ( ) const { return type; }
+
+		/**
+		 * Returns the prime of the generator that made the tape.
+		 *
+		 * @return The parameter p.
+		 */
+		unsigned long get_p ( ) const { return p; }
+
+		/**
+		 * Returns the "a" parameter of the generator that made the tape.
+		 *
+		 * @return The parameter a.
+		 */
+		unsigned long get_a ( ) const { return a; }
+
+		/**
+		 * Returns the "b" parameter of the generator that made the tape.
+		 *
+		 * @return The parameter b.
+		 */
+		unsigned long get_b ( ) const { return b; }
+
+		/**
+		 * Returns the seed of the generator that made the tape.
+		 *
+		 * @return The seed.
+		 */
+		unsigned long get_seed ( ) const { return seed; }
+
+		/**
+		 * Returns the position in the sequence where the tape starts.
+		 *
+		 * @return The number of jump ( ) steps before the first segment.
+		 */
+		unsigned long long get_offset ( ) const { return offset; }
+
+		/**
+		 * Returns the number of independently generated segments.
+		 *
+		 * @return The segment count.
+		 */
+		unsigned get_segments ( ) const { return segments; }
+
+	private:
+		const unsigned char * base;
+		size_t mappedSize;
+
+		ValueType type;
+		unsigned long p, a, b, seed;
+		unsigned long long offset, numValues, checksum;
+		unsigned segments;
+
+		// not copyable: the mapping is owned
+		ICGTape ( const ICGTape & );
+		ICGTape & operator = ( const ICGTape & );
+
+		static unsigned long long computeChecksum ( const unsigned char * data, size_t bytes, unsigned threads );
+};
+
+#endif /* __ICGTAPE_H__ */
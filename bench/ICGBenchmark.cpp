@@ -0,0 +1,193 @@
+/**
+ * Micro-benchmark of every ICG entry point.
+ *
+ * Measures ns/call and calls/sec for the generation methods of ICG, for construction (which includes
+ * the primality test), ICG :: isPrime ( ), ICG :: inverse ( ), the ICGStatic wrappers and the bulk kernels
+ * of ICGKernels at every level the CPU supports (a call there processes a block of KERNEL_BLOCK values).
+ * The ICG methods are measured for a 24, a 31 and a 61 bit prime; std :: mt19937_64 and
+ * std :: minstd_rand are measured as references. The results are written as JSON, so they can be
+ * stored per release and compared.
+ *
+ * Build and run from the repository root:
+ *
+ * 	g++ -O2 -std=c++11 -I. bench/ICGBenchmark.cpp ICG.cpp ICGStatic.cpp ICGKernels.cpp -o icg-benchmark
+ * 	./icg-benchmark [--calls N] [--out results.json]
+ *
+ * --calls sets the number of calls per measurement (default 2000000, construction uses 1/100 of it).
+ * Without --out the JSON is written to stdout.
+ */
+
+#include "ICG.h"
+#include "ICGKernels.h"
+#include "ICGStatic.h"
+#include <stdio.h> // using: fprintf ( ), fopen ( )
+#include <stdlib.h> // using: strtoull ( )
+#include <string.h> // using: strcmp ( )
+#include <chrono> // using: std::chrono::steady_clock
+#include <random> // using: std::mt19937_64, std::minstd_rand
+#include <string> // using: std::string
+#include <vector> // using: std::vector
+
+namespace {
+
+struct Result {
+	std :: string name;
+	int primeBits;
+	unsigned long long p;
+	unsigned long long calls;
+	double seconds;
+};
+
+// Keeps results alive so the measured calls cannot be optimized away.
+volatile unsigned long long sinkInt;
+volatile double sinkDouble;
+
+/**
+ * Runs body ( i ) for i = 0, 1, ..., calls-1 and records the elapsed time.
+ */
+template < class Body >
+void measure ( std :: vector < Result > & results, const char * name, int primeBits, unsigned long long p, unsigned long long calls, Body body ) {
+	// Warm up caches and branch predictors.
+	for ( unsigned long long i = 0; i < calls / 100 + 1; i++ ) body ( i );
+
+	std :: chrono :: steady_clock :: time_point start = std :: chrono :: steady_clock :: now ( );
+	for ( unsigned long long i = 0; i < calls; i++ ) body ( i );
+	std :: chrono :: duration < double > elapsed = std :: chrono :: steady_clock :: now ( ) - start;
+
+	Result r = { name, primeBits, p, calls, elapsed.count ( ) };
+	results.push_back ( r );
+	fprintf ( stderr, "%-28s %2d bit  %10.2f ns/call\n", name, primeBits, 1e9 * r.seconds / calls );
+}
+
+struct PrimeConfig {
+	int bits;
+	unsigned long p, a, b;
+};
+
+void benchmarkICG ( std :: vector < Result > & results, const PrimeConfig & cfg, unsigned long long calls ) {
+	ICG icg ( cfg.p, cfg.a, cfg.b, 12345 );
+	const int bits = cfg.bits;
+	const unsigned long long p = cfg.p;
+
+	measure ( results, "ICG::rand()", bits, p, calls, [ & ] ( unsigned long long ) { sinkInt = icg.rand ( ); } );
+	measure ( results, "ICG::rand(range)", bits, p, calls, [ & ] ( unsigned long long ) { sinkInt = icg.rand ( 1000 ); } );
+	measure ( results, "ICG::randBounded(range)", bits, p, calls, [ & ] ( unsigned long long ) { sinkInt = icg.randBounded ( 1000 ); } );
+	measure ( results, "ICG::rand01()", bits, p, calls, [ & ] ( unsigned long long ) { sinkDouble = icg.rand01 ( ); } );
+	measure ( results, "ICG::randInterval()", bits, p, calls, [ & ] ( unsigned long long ) { sinkDouble = icg.randInterval ( 20.0, 25.0 ); } );
+	measure ( results, "ICG::randStdNorm()", bits, p, calls, [ & ] ( unsigned long long ) { sinkDouble = icg.randStdNorm ( ); } );
+	measure ( results, "ICG::randNormal()", bits, p, calls, [ & ] ( unsigned long long ) { sinkDouble = icg.randNormal ( 5.0, 2.0 ); } );
+	measure ( results, "ICG::randBit()", bits, p, calls, [ & ] ( unsigned long long ) { sinkInt = icg.randBit ( ); } );
+	measure ( results, "ICG::rand32()", bits, p, calls, [ & ] ( unsigned long long ) { sinkInt = icg.rand32 ( ); } );
+	measure ( results, "ICG::rand64()", bits, p, calls, [ & ] ( unsigned long long ) { sinkInt = icg.rand64 ( ); } );
+
+	// inverse ( ) of a pseudorandom argument, so the Euclid loop lengths vary as in rand ( )
+	unsigned long long y = 1;
+	measure ( results, "ICG::inverse()", bits, p, calls, [ & ] ( unsigned long long ) {
+		y = ( y * 6364136223846793005ULL + 1442695040888963407ULL );
+		sinkInt = icg.inverse ( ( unsigned long ) ( ( y >> 1 ) % ( p - 1 ) + 1 ) );
+	} );
+
+	measure ( results, "ICG::isPrime()", bits, p, calls / 100, [ & ] ( unsigned long long ) { sinkInt = ICG :: isPrime ( cfg.p ); } );
+	measure ( results, "ICG::ICG()", bits, p, calls / 100, [ & ] ( unsigned long long i ) {
+		ICG fresh ( cfg.p, cfg.a, cfg.b, ( unsigned long ) ( i % cfg.p ) );
+		sinkInt = fresh.isValid ( );
+	} );
+}
+
+const size_t KERNEL_BLOCK = 1024;
+
+void benchmarkKernels ( std :: vector < Result > & results, const PrimeConfig & cfg, unsigned long long calls ) {
+	ICG icg ( cfg.p, cfg.a, cfg.b, 12345 );
+	std :: vector < unsigned long > raw ( KERNEL_BLOCK ), inv ( KERNEL_BLOCK );
+	std :: vector < double > unit ( KERNEL_BLOCK );
+	icg.fill ( &raw [ 0 ], raw.size ( ) );
+
+	const ICGKernels :: Level restore = ICGKernels :: active ( );
+	for ( int l = ICGKernels :: SCALAR; l <= ICGKernels :: detected ( ); l++ ) {
+		ICGKernels :: select ( ( ICGKernels :: Level ) l );
+		std :: string level = ICGKernels :: name ( ( ICGKernels :: Level ) l );
+		measure ( results, ( "ICGKernels::toUnit[" + level + "]" ).c_str ( ), cfg.bits, cfg.p, calls / KERNEL_BLOCK + 1, [ & ] ( unsigned long long ) {
+			ICGKernels :: toUnit ( &raw [ 0 ], &unit [ 0 ], KERNEL_BLOCK, cfg.p );
+			sinkDouble = unit [ KERNEL_BLOCK - 1 ];
+		} );
+		measure ( results, ( "ICGKernels::inverse[" + level + "]" ).c_str ( ), cfg.bits, cfg.p, calls / KERNEL_BLOCK / 10 + 1, [ & ] ( unsigned long long ) {
+			ICGKernels :: inverse ( &raw [ 0 ], &inv [ 0 ], KERNEL_BLOCK, cfg.p );
+			sinkInt = inv [ KERNEL_BLOCK - 1 ];
+		} );
+		// 256 streams by 4 steps
+		std :: vector < unsigned long > states ( raw.begin ( ), raw.begin ( ) + 256 );
+		measure ( results, ( "ICGKernels::step[" + level + "]" ).c_str ( ), cfg.bits, cfg.p, calls / KERNEL_BLOCK / 10 + 1, [ & ] ( unsigned long long ) {
+			ICGKernels :: step ( &states [ 0 ], 256, &inv [ 0 ], KERNEL_BLOCK / 256, cfg.p, cfg.a, cfg.b );
+			sinkInt = inv [ KERNEL_BLOCK - 1 ];
+		} );
+	}
+	ICGKernels :: select ( restore );
+}
+
+void writeJson ( FILE * out, const std :: vector < Result > & results ) {
+	fprintf ( out, "{\n" );
+#if defined ( __VERSION__ )
+	fprintf ( out, "  \"compiler\": \"%s\",\n", __VERSION__ );
+#endif
+	fprintf ( out, "  \"results\": [\n" );
+	for ( size_t i = 0; i < results.size ( ); i++ ) {
+		const Result & r = results [ i ];
+		double ns = 1e9 * r.seconds / r.calls;
+		fprintf ( out, "    { \"name\": \"%s\", \"prime_bits\": %d, \"p\": %llu, \"calls\": %llu, \"ns_per_call\": %.3f, \"calls_per_sec\": %.1f }%s\n",
+				  r.name.c_str ( ), r.primeBits, r.p, r.calls, ns, r.calls / r.seconds, ( i + 1 < results.size ( ) ) ? "," : "" );
+	}
+	fprintf ( out, "  ]\n}\n" );
+}
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	unsigned long long calls = 2000000;
+	const char * outPath = 0;
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--calls" ) == 0 && i + 1 < argc ) calls = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--out" ) == 0 && i + 1 < argc ) outPath = argv [ ++i ];
+		else {
+			fprintf ( stderr, "usage: %s [--calls N] [--out results.json]\n", argv [ 0 ] );
+			return 2;
+		}
+	}
+	if ( calls < 100 ) calls = 100;
+
+	const PrimeConfig primes [ ] = {
+		{ 24, 15485863UL, 213UL, 64UL },
+		{ 31, 2147483647UL, 16807UL, 1UL },
+		{ 61, 2305843009213693951UL, 1234567UL, 1UL }
+	};
+
+	std :: vector < Result > results;
+	for ( size_t i = 0; i < sizeof ( primes ) / sizeof ( primes [ 0 ] ); i++ ) benchmarkICG ( results, primes [ i ], calls );
+	for ( size_t i = 0; i < sizeof ( primes ) / sizeof ( primes [ 0 ] ); i++ ) benchmarkKernels ( results, primes [ i ], calls );
+
+	measure ( results, "ICGStatic::rand(range)", 24, 15485863ULL, calls, [ ] ( unsigned long long ) { sinkInt = ICGStatic :: rand ( 1000 ); } );
+	measure ( results, "ICGStatic::rand01()", 24, 15485863ULL, calls, [ ] ( unsigned long long ) { sinkDouble = ICGStatic :: rand01 ( ); } );
+	measure ( results, "ICGStatic::randInterval()", 24, 15485863ULL, calls, [ ] ( unsigned long long ) { sinkDouble = ICGStatic :: randInterval ( 20.0, 25.0 ); } );
+	measure ( results, "ICGStatic::randStdNorm()", 24, 15485863ULL, calls, [ ] ( unsigned long long ) { sinkDouble = ICGStatic :: randStdNorm ( ); } );
+	measure ( results, "ICGStatic::randNormal()", 24, 15485863ULL, calls, [ ] ( unsigned long long ) { sinkDouble = ICGStatic :: randNormal ( 5.0, 2.0 ); } );
+
+	std :: mt19937_64 mt ( 12345 );
+	std :: minstd_rand minstd ( 12345 );
+	std :: uniform_real_distribution < double > unit ( 0.0, 1.0 );
+	std :: normal_distribution < double > normal ( 0.0, 1.0 );
+	measure ( results, "std::mt19937_64()", 0, 0, calls, [ & ] ( unsigned long long ) { sinkInt = mt ( ); } );
+	measure ( results, "std::mt19937_64 uniform01", 0, 0, calls, [ & ] ( unsigned long long ) { sinkDouble = unit ( mt ); } );
+	measure ( results, "std::mt19937_64 normal", 0, 0, calls, [ & ] ( unsigned long long ) { sinkDouble = normal ( mt ); } );
+	measure ( results, "std::minstd_rand()", 0, 0, calls, [ & ] ( unsigned long long ) { sinkInt = minstd ( ); } );
+	measure ( results, "std::minstd_rand uniform01", 0, 0, calls, [ & ] ( unsigned long long ) { sinkDouble = unit ( minstd ); } );
+
+	FILE * out = outPath ? fopen ( outPath, "w" ) : stdout;
+	if ( !out ) {
+		fprintf ( stderr, "cannot open %s\n", outPath );
+		return 1;
+	}
+	writeJson ( out, results );
+	if ( outPath ) fclose ( out );
+
+	return 0;
+}
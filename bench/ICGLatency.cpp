@@ -0,0 +1,308 @@
+/**
+ * Per-call latency distribution of ICG :: rand ( ) and ICG :: randStdNorm ( ).
+ *
+ * The number of iterations of the extended Euclidean algorithm in ICG :: inverse ( ) depends on the
+ * argument, and randStdNorm ( ) rejects about 21% of its candidate pairs, so the per-call latency
+ * has a tail that the mean hides. This benchmark times every single call with the time stamp counter
+ * (rdtsc / rdtscp, in TSC ticks; other platforms fall back to steady_clock nanoseconds), collects the
+ * timings in log-linear histograms with < 1% relative bucket width, and reports p50, p90, p99, p99.9,
+ * p99.99 and max. The timer overhead, measured on empty intervals, is subtracted.
+ *
+ * For rand ( ) it also records the histogram of Euclid loop iterations, and the median latency per
+ * iteration count, which shows how much of the tail is explained by long divisions chains.
+ * Both methods are measured a second time in the constant-work mode of ICG :: setConstantWork ( ),
+ * whose p99.9 should be within a few percent of its p50.
+ *
+ * Build and run from the repository root:
+ *
+ * 	g++ -O2 -std=c++11 -I. bench/ICGLatency.cpp ICG.cpp -o icg-latency
+ * 	./icg-latency [--calls N] [--out latency.json]
+ *
+ * A summary is printed to stderr, the full results are written as JSON.
+ */
+
+#include "ICG.h"
+#include <stdio.h> // using: fprintf ( ), fopen ( )
+#include <stdlib.h> // using: strtoull ( )
+#include <string.h> // using: strcmp ( )
+#include <chrono> // using: std::chrono::steady_clock
+#include <string> // using: std::string
+#include <vector> // using: std::vector
+
+#if defined ( __x86_64__ ) || defined ( __i386__ )
+#include <x86intrin.h> // using: __rdtsc ( ), __rdtscp ( ), _mm_lfence ( )
+#define ICG_LATENCY_TSC 1
+#endif
+
+namespace {
+
+#if defined ( ICG_LATENCY_TSC )
+const char * const TIMER_UNIT = "tsc_ticks";
+
+inline unsigned long long timerStart ( ) {
+	_mm_lfence ( );
+	unsigned long long t = __rdtsc ( );
+	_mm_lfence ( );
+	return t;
+}
+
+inline unsigned long long timerStop ( ) {
+	unsigned aux;
+	unsigned long long t = __rdtscp ( &aux );
+	_mm_lfence ( );
+	return t;
+}
+#else
+const char * const TIMER_UNIT = "ns";
+
+inline unsigned long long timerStart ( ) {
+	return std :: chrono :: duration_cast < std :: chrono :: nanoseconds > ( std :: chrono :: steady_clock :: now ( ).time_since_epoch ( ) ).count ( );
+}
+
+inline unsigned long long timerStop ( ) { return timerStart ( ); }
+#endif
+
+/**
+ * Log-linear histogram in the style of HdrHistogram.
+ *
+ * Values below 2^SUB_BITS get a bucket each; above that every power of two is split into
+ * 2^(SUB_BITS-1) equal buckets, so the relative bucket width stays below 2^-(SUB_BITS-1).
+ */
+class LatencyHistogram {
+	public:
+		static const unsigned SUB_BITS = 8;
+
+		LatencyHistogram ( ) : counts ( ( 64 - SUB_BITS + 2 ) << ( SUB_BITS - 1 ), 0 ), total ( 0 ), maxValue ( 0 ) { }
+
+		void record ( unsigned long long v ) {
+			counts [ bucketOf ( v ) ]++;
+			total++;
+			if ( v > maxValue ) maxValue = v;
+		}
+
+		unsigned long long count ( ) const { return total; }
+		unsigned long long max ( ) const { return maxValue; }
+
+		/**
+		 * Returns the upper bound of the bucket containing the q-quantile.
+		 */
+		unsigned long long quantile ( double q ) const {
+			if ( total == 0 ) return 0;
+			unsigned long long rank = ( unsigned long long ) ( q * ( total - 1 ) ) + 1, seen = 0;
+			for ( size_t i = 0; i < counts.size ( ); i++ ) {
+				seen += counts [ i ];
+				if ( seen >= rank ) {
+					unsigned long long upper = upperBound ( i );
+					return upper < maxValue ? upper : maxValue;
+				}
+			}
+			return maxValue;
+		}
+
+	private:
+		std :: vector < unsigned long long > counts;
+		unsigned long long total, maxValue;
+
+		static size_t bucketOf ( unsigned long long v ) {
+			if ( v < ( 1ULL << SUB_BITS ) ) return ( size_t ) v;
+			unsigned e = 63 - __builtin_clzll ( v );					// 2^e <= v < 2^(e+1), e >= SUB_BITS
+			unsigned long long sub = ( v >> ( e - SUB_BITS + 1 ) ) & ( ( 1ULL << ( SUB_BITS - 1 ) ) - 1 );
+			return ( size_t ) ( ( 1ULL << SUB_BITS ) + ( ( unsigned long long ) ( e - SUB_BITS ) << ( SUB_BITS - 1 ) ) + sub );
+		}
+
+		static unsigned long long upperBound ( size_t bucket ) {
+			if ( bucket < ( 1ULL << SUB_BITS ) ) return bucket;
+			size_t rest = bucket - ( 1ULL << SUB_BITS );
+			unsigned e = ( unsigned ) ( rest >> ( SUB_BITS - 1 ) ) + SUB_BITS;
+			unsigned long long sub = rest & ( ( 1ULL << ( SUB_BITS - 1 ) ) - 1 );
+			unsigned long long width = 1ULL << ( e - SUB_BITS + 1 );
+			return ( 1ULL << e ) + sub * width + width - 1;
+		}
+};
+
+/**
+ * Counts the division steps inverse ( y ) performs for the prime p.
+ *
+ * Mirrors the remainder sequence of the extended Euclidean algorithm in ICG :: inverse ( ),
+ * which only depends on p and y.
+ */
+unsigned euclidIterations ( unsigned long long p, unsigned long long y ) {
+	if ( y <= 1 || y >= p ) return 0;
+	unsigned steps = 0;
+	unsigned long long rn = p, rn1 = y;
+	while ( rn1 != 0 ) {
+		unsigned long long r = rn % rn1;
+		rn = rn1;
+		rn1 = r;
+		steps++;
+	}
+	return steps;
+}
+
+/**
+ * Minimum cost of an empty timed interval, subtracted from all measurements.
+ */
+unsigned long long timerOverhead ( ) {
+	unsigned long long best = ~0ULL;
+	for ( int i = 0; i < 100000; i++ ) {
+		unsigned long long t0 = timerStart ( );
+		unsigned long long t1 = timerStop ( );
+		if ( t1 - t0 < best ) best = t1 - t0;
+	}
+	return best;
+}
+
+struct Series {
+	std :: string name;
+	int primeBits;
+	LatencyHistogram histogram;
+};
+
+struct PrimeConfig {
+	int bits;
+	unsigned long p, a, b;
+};
+
+void printSummary ( const Series & s ) {
+	unsigned long long p50 = s.histogram.quantile ( 0.5 ), p999 = s.histogram.quantile ( 0.999 );
+	fprintf ( stderr, "%-26s %2d bit  p50 %6llu  p99 %6llu  p99.9 %6llu (%+6.1f%%)  max %8llu %s\n",
+			  s.name.c_str ( ), s.primeBits, p50, s.histogram.quantile ( 0.99 ), p999,
+			  p50 ? 100.0 * ( ( double ) p999 / p50 - 1.0 ) : 0.0, s.histogram.max ( ), TIMER_UNIT );
+}
+
+void writeSeries ( FILE * out, const Series & s ) {
+	const LatencyHistogram & h = s.histogram;
+	fprintf ( out, "{ \"name\": \"%s\", \"prime_bits\": %d, \"calls\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"p9999\": %llu, \"max\": %llu }",
+			  s.name.c_str ( ), s.primeBits, h.count ( ), h.quantile ( 0.5 ), h.quantile ( 0.9 ), h.quantile ( 0.99 ),
+			  h.quantile ( 0.999 ), h.quantile ( 0.9999 ), h.max ( ) );
+}
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	unsigned long long calls = 1000000;
+	const char * outPath = 0;
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--calls" ) == 0 && i + 1 < argc ) calls = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--out" ) == 0 && i + 1 < argc ) outPath = argv [ ++i ];
+		else {
+			fprintf ( stderr, "usage: %s [--calls N] [--out latency.json]\n", argv [ 0 ] );
+			return 2;
+		}
+	}
+
+	const PrimeConfig primes [ ] = {
+		{ 24, 15485863UL, 213UL, 64UL },
+		{ 31, 2147483647UL, 16807UL, 1UL },
+		{ 61, 2305843009213693951UL, 1234567UL, 1UL }
+	};
+	const size_t numPrimes = sizeof ( primes ) / sizeof ( primes [ 0 ] );
+
+	const unsigned long long overhead = timerOverhead ( );
+	fprintf ( stderr, "timer overhead %llu %s\n", overhead, TIMER_UNIT );
+
+	std :: vector < Series > series;
+	std :: vector < std :: vector < unsigned long long > > iterationCounts ( numPrimes );
+	std :: vector < std :: vector < LatencyHistogram > > latencyByIterations ( numPrimes );
+
+	for ( size_t c = 0; c < numPrimes; c++ ) {
+		const PrimeConfig & cfg = primes [ c ];
+		ICG icg ( cfg.p, cfg.a, cfg.b, 12345 );
+
+		Series randSeries;
+		randSeries.name = "ICG::rand()";
+		randSeries.primeBits = cfg.bits;
+
+		// rand ( ) inverts the previous output, so the iteration count is known before the call.
+		unsigned long long cur = 12345;
+		for ( unsigned long long i = 0; i < calls; i++ ) {
+			unsigned iterations = euclidIterations ( cfg.p, cur );
+
+			unsigned long long t0 = timerStart ( );
+			cur = icg.rand ( );
+			unsigned long long t1 = timerStop ( );
+			unsigned long long ticks = ( t1 - t0 > overhead ) ? t1 - t0 - overhead : 0;
+
+			randSeries.histogram.record ( ticks );
+			if ( iterations >= iterationCounts [ c ].size ( ) ) {
+				iterationCounts [ c ].resize ( iterations + 1, 0 );
+				latencyByIterations [ c ].resize ( iterations + 1 );
+			}
+			iterationCounts [ c ] [ iterations ]++;
+			latencyByIterations [ c ] [ iterations ].record ( ticks );
+		}
+		series.push_back ( randSeries );
+		printSummary ( series.back ( ) );
+
+		Series normSeries;
+		normSeries.name = "ICG::randStdNorm()";
+		normSeries.primeBits = cfg.bits;
+		volatile double sink = 0.0;
+		for ( unsigned long long i = 0; i < calls; i++ ) {
+			unsigned long long t0 = timerStart ( );
+			sink = icg.randStdNorm ( );
+			unsigned long long t1 = timerStop ( );
+			normSeries.histogram.record ( ( t1 - t0 > overhead ) ? t1 - t0 - overhead : 0 );
+		}
+		series.push_back ( normSeries );
+		printSummary ( series.back ( ) );
+
+		// The same calls in constant-work mode, whose p99.9 should stay close to its p50.
+		icg.setConstantWork ( true );
+
+		Series constRandSeries;
+		constRandSeries.name = "ICG::rand() const";
+		constRandSeries.primeBits = cfg.bits;
+		for ( unsigned long long i = 0; i < calls; i++ ) {
+			unsigned long long t0 = timerStart ( );
+			cur = icg.rand ( );
+			unsigned long long t1 = timerStop ( );
+			constRandSeries.histogram.record ( ( t1 - t0 > overhead ) ? t1 - t0 - overhead : 0 );
+		}
+		series.push_back ( constRandSeries );
+		printSummary ( series.back ( ) );
+
+		Series constNormSeries;
+		constNormSeries.name = "ICG::randStdNorm() const";
+		constNormSeries.primeBits = cfg.bits;
+		for ( unsigned long long i = 0; i < calls; i++ ) {
+			unsigned long long t0 = timerStart ( );
+			sink = icg.randStdNorm ( );
+			unsigned long long t1 = timerStop ( );
+			constNormSeries.histogram.record ( ( t1 - t0 > overhead ) ? t1 - t0 - overhead : 0 );
+		}
+		series.push_back ( constNormSeries );
+		printSummary ( series.back ( ) );
+		( void ) sink;
+	}
+
+	FILE * out = outPath ? fopen ( outPath, "w" ) : stdout;
+	if ( !out ) {
+		fprintf ( stderr, "cannot open %s\n", outPath );
+		return 1;
+	}
+
+	fprintf ( out, "{\n  \"unit\": \"%s\",\n  \"timer_overhead\": %llu,\n  \"latency\": [\n", TIMER_UNIT, overhead );
+	for ( size_t i = 0; i < series.size ( ); i++ ) {
+		fprintf ( out, "    " );
+		writeSeries ( out, series [ i ] );
+		fprintf ( out, "%s\n", ( i + 1 < series.size ( ) ) ? "," : "" );
+	}
+	fprintf ( out, "  ],\n  \"euclid_iterations\": [\n" );
+	for ( size_t c = 0; c < numPrimes; c++ ) {
+		fprintf ( out, "    { \"prime_bits\": %d, \"histogram\": [", primes [ c ].bits );
+		bool first = true;
+		for ( size_t k = 0; k < iterationCounts [ c ].size ( ); k++ ) {
+			if ( iterationCounts [ c ] [ k ] == 0 ) continue;
+			fprintf ( out, "%s { \"iterations\": %zu, \"count\": %llu, \"p50\": %llu }", first ? "" : ",", k,
+					  iterationCounts [ c ] [ k ], latencyByIterations [ c ] [ k ].quantile ( 0.5 ) );
+			first = false;
+		}
+		fprintf ( out, " ] }%s\n", ( c + 1 < numPrimes ) ? "," : "" );
+	}
+	fprintf ( out, "  ]\n}\n" );
+	if ( outPath ) fclose ( out );
+
+	return 0;
+}
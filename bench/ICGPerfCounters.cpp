@@ -0,0 +1,247 @@
+/**
+ * Hardware performance counters for the ICG kernels.
+ *
+ * Runs each kernel in a loop wrapped in perf_event_open counters for cycles, instructions,
+ * branch misses, L1 data cache read misses, last level cache misses and, where the CPU has such
+ * an event, cycles with the divider active. It reports IPC and every counter per generated number,
+ * which shows whether ICG :: inverse ( ) is bound by division latency or by branch mispredictions.
+ *
+ * Counters that cannot be opened (no PMU in a virtual machine, kernel.perf_event_paranoid too high,
+ * unknown raw event) are reported as null, and the wall-clock time per call is always measured,
+ * so the harness works everywhere, down to plain timing on non-Linux systems.
+ *
+ * The divider event is model specific and has to be passed as a raw event code, e.g. 0x0114
+ * (ARITH.DIVIDER_ACTIVE, Intel Skylake and later) or 0x01d3 (AMD Zen, DIV_CYCLES_BUSY_COUNT).
+ *
+ * Build and run from the repository root:
+ *
+ * 	g++ -O2 -std=c++11 -I. bench/ICGPerfCounters.cpp ICG.cpp -o icg-perf
+ * 	./icg-perf [--calls N] [--divider-event 0x0114] [--out counters.json]
+ */
+
+#include "ICG.h"
+#include <stdio.h> // using: fprintf ( ), fopen ( )
+#include <stdlib.h> // using: strtoull ( )
+#include <string.h> // using: strcmp ( ), memset ( ), strerror ( )
+#include <chrono> // using: std::chrono::steady_clock
+#include <string> // using: std::string
+#include <vector> // using: std::vector
+
+#if defined ( __linux__ )
+#include <errno.h> // using: errno
+#include <unistd.h> // using: syscall ( ), read ( ), close ( )
+#include <sys/ioctl.h> // using: ioctl ( )
+#include <sys/syscall.h> // using: SYS_perf_event_open
+#include <linux/perf_event.h> // using: perf_event_attr, PERF_*
+#define ICG_PERF_EVENTS 1
+#endif
+
+namespace {
+
+struct CounterSpec {
+	const char * name;
+	unsigned type;
+	unsigned long long config;
+};
+
+/**
+ * One counter per event, opened independently so that missing events do not disable the others.
+ */
+class CounterSet {
+	public:
+		CounterSet ( const std :: vector < CounterSpec > & specs ) : specs ( specs ), fds ( specs.size ( ), -1 ) {
+#if defined ( ICG_PERF_EVENTS )
+			for ( size_t i = 0; i < specs.size ( ); i++ ) {
+				struct perf_event_attr attr;
+				memset ( &attr, 0, sizeof ( attr ) );
+				attr.size = sizeof ( attr );
+				attr.type = specs [ i ].type;
+				attr.config = specs [ i ].config;
+				attr.disabled = 1;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+				fds [ i ] = ( int ) syscall ( SYS_perf_event_open, &attr, 0, -1, -1, 0 );
+				if ( fds [ i ] < 0 ) fprintf ( stderr, "counter %-14s unavailable: %s\n", specs [ i ].name, strerror ( errno ) );
+			}
+#else
+			fprintf ( stderr, "perf_event_open is not available on this platform, measuring time only\n" );
+#endif
+		}
+
+		~CounterSet ( ) {
+#if defined ( ICG_PERF_EVENTS )
+			for ( size_t i = 0; i < fds.size ( ); i++ ) if ( fds [ i ] >= 0 ) close ( fds [ i ] );
+#endif
+		}
+
+		void start ( ) {
+#if defined ( ICG_PERF_EVENTS )
+			for ( size_t i = 0; i < fds.size ( ); i++ ) {
+				if ( fds [ i ] < 0 ) continue;
+				ioctl ( fds [ i ], PERF_EVENT_IOC_RESET, 0 );
+				ioctl ( fds [ i ], PERF_EVENT_IOC_ENABLE, 0 );
+			}
+#endif
+		}
+
+		void stop ( ) {
+#if defined ( ICG_PERF_EVENTS )
+			for ( size_t i = 0; i < fds.size ( ); i++ ) if ( fds [ i ] >= 0 ) ioctl ( fds [ i ], PERF_EVENT_IOC_DISABLE, 0 );
+#endif
+		}
+
+		/**
+		 * Reads counter i, scaled up if the kernel multiplexed it. Returns false if it is unavailable.
+		 */
+		bool read ( size_t i, double & value ) const {
+#if defined ( ICG_PERF_EVENTS )
+			if ( fds [ i ] < 0 ) return false;
+			unsigned long long data [ 3 ];
+			if ( :: read ( fds [ i ], data, sizeof ( data ) ) != ( ssize_t ) sizeof ( data ) || data [ 2 ] == 0 ) return false;
+			value = ( double ) data [ 0 ] * ( ( double ) data [ 1 ] / ( double ) data [ 2 ] );
+			return true;
+#else
+			( void ) i;
+			( void ) value;
+			return false;
+#endif
+		}
+
+		size_t size ( ) const { return specs.size ( ); }
+		const char * name ( size_t i ) const { return specs [ i ].name; }
+
+	private:
+		std :: vector < CounterSpec > specs;
+		std :: vector < int > fds;
+};
+
+struct KernelResult {
+	std :: string name;
+	unsigned long long calls;
+	double seconds;
+	std :: vector < double > values;
+	std :: vector < bool > valid;
+};
+
+volatile unsigned long long sinkInt;
+volatile double sinkDouble;
+
+template < class Body >
+KernelResult runKernel ( CounterSet & counters, const char * name, unsigned long long calls, Body body ) {
+	for ( unsigned long long i = 0; i < calls / 100 + 1; i++ ) body ( );
+
+	std :: chrono :: steady_clock :: time_point t0 = std :: chrono :: steady_clock :: now ( );
+	counters.start ( );
+	for ( unsigned long long i = 0; i < calls; i++ ) body ( );
+	counters.stop ( );
+	std :: chrono :: duration < double > elapsed = std :: chrono :: steady_clock :: now ( ) - t0;
+
+	KernelResult r;
+	r.name = name;
+	r.calls = calls;
+	r.seconds = elapsed.count ( );
+	for ( size_t i = 0; i < counters.size ( ); i++ ) {
+		double v = 0.0;
+		bool ok = counters.read ( i, v );
+		r.values.push_back ( v );
+		r.valid.push_back ( ok );
+	}
+	return r;
+}
+
+void printResult ( const CounterSet & counters, const KernelResult & r ) {
+	fprintf ( stderr, "%-22s %8.2f ns/call", r.name.c_str ( ), 1e9 * r.seconds / r.calls );
+	// Counter 0 is cycles and counter 1 instructions, see main ( ).
+	if ( r.valid [ 0 ] && r.valid [ 1 ] && r.values [ 0 ] > 0 ) fprintf ( stderr, "  IPC %5.2f", r.values [ 1 ] / r.values [ 0 ] );
+	for ( size_t i = 0; i < counters.size ( ); i++ ) {
+		if ( r.valid [ i ] ) fprintf ( stderr, "  %s %.2f", counters.name ( i ), r.values [ i ] / r.calls );
+	}
+	fprintf ( stderr, "\n" );
+}
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	unsigned long long calls = 1000000, dividerEvent = 0;
+	const char * outPath = 0;
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--calls" ) == 0 && i + 1 < argc ) calls = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--divider-event" ) == 0 && i + 1 < argc ) dividerEvent = strtoull ( argv [ ++i ], 0, 0 );
+		else if ( strcmp ( argv [ i ], "--out" ) == 0 && i + 1 < argc ) outPath = argv [ ++i ];
+		else {
+			fprintf ( stderr, "usage: %s [--calls N] [--divider-event RAW] [--out counters.json]\n", argv [ 0 ] );
+			return 2;
+		}
+	}
+	if ( calls == 0 ) calls = 1;
+
+	std :: vector < CounterSpec > specs;
+#if defined ( ICG_PERF_EVENTS )
+	const CounterSpec cycles = { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES };
+	const CounterSpec instructions = { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS };
+	const CounterSpec branchMisses = { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES };
+	const CounterSpec l1Misses = { "L1d-misses", PERF_TYPE_HW_CACHE,
+		PERF_COUNT_HW_CACHE_L1D | ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) };
+	const CounterSpec llcMisses = { "LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES };
+	specs.push_back ( cycles );
+	specs.push_back ( instructions );
+	specs.push_back ( branchMisses );
+	specs.push_back ( l1Misses );
+	specs.push_back ( llcMisses );
+	if ( dividerEvent != 0 ) {
+		const CounterSpec divider = { "divider-active", PERF_TYPE_RAW, dividerEvent };
+		specs.push_back ( divider );
+	}
+#else
+	// Placeholders keep the column layout; all of them are reported as unavailable.
+	const CounterSpec none [ ] = { { "cycles", 0, 0 }, { "instructions", 0, 0 } };
+	specs.assign ( none, none + 2 );
+#endif
+
+	CounterSet counters ( specs );
+
+	ICG icg ( 15485863, 213, 64, 12345 );
+	ICG wide ( 2305843009213693951UL, 1234567, 1, 12345 );
+	ICG constant ( 15485863, 213, 64, 12345 );
+	constant.setConstantWork ( true );
+	unsigned long long y = 1;
+
+	std :: vector < KernelResult > results;
+	results.push_back ( runKernel ( counters, "rand() 24 bit", calls, [ & ] ( ) { sinkInt = icg.rand ( ); } ) );
+	results.push_back ( runKernel ( counters, "rand() 61 bit", calls, [ & ] ( ) { sinkInt = wide.rand ( ); } ) );
+	results.push_back ( runKernel ( counters, "rand() const 24 bit", calls, [ & ] ( ) { sinkInt = constant.rand ( ); } ) );
+	results.push_back ( runKernel ( counters, "inverse() 24 bit", calls, [ & ] ( ) {
+		y = y * 6364136223846793005ULL + 1442695040888963407ULL;
+		sinkInt = icg.inverse ( ( unsigned long ) ( ( y >> 1 ) % 15485862 + 1 ) );
+	} ) );
+	results.push_back ( runKernel ( counters, "randStdNorm() 24 bit", calls, [ & ] ( ) { sinkDouble = icg.randStdNorm ( ); } ) );
+	results.push_back ( runKernel ( counters, "randBounded() 24 bit", calls, [ & ] ( ) { sinkInt = icg.randBounded ( 1000 ); } ) );
+	results.push_back ( runKernel ( counters, "rand32() 24 bit", calls, [ & ] ( ) { sinkInt = icg.rand32 ( ); } ) );
+
+	for ( size_t i = 0; i < results.size ( ); i++ ) printResult ( counters, results [ i ] );
+
+	FILE * out = outPath ? fopen ( outPath, "w" ) : stdout;
+	if ( !out ) {
+		fprintf ( stderr, "cannot open %s\n", outPath );
+		return 1;
+	}
+	fprintf ( out, "{\n  \"kernels\": [\n" );
+	for ( size_t k = 0; k < results.size ( ); k++ ) {
+		const KernelResult & r = results [ k ];
+		fprintf ( out, "    { \"name\": \"%s\", \"calls\": %llu, \"ns_per_call\": %.3f", r.name.c_str ( ), r.calls, 1e9 * r.seconds / r.calls );
+		if ( r.valid [ 0 ] && r.valid [ 1 ] && r.values [ 0 ] > 0 ) fprintf ( out, ", \"ipc\": %.3f", r.values [ 1 ] / r.values [ 0 ] );
+		else fprintf ( out, ", \"ipc\": null" );
+		for ( size_t i = 0; i < counters.size ( ); i++ ) {
+			if ( r.valid [ i ] ) fprintf ( out, ", \"%s_per_call\": %.4f", counters.name ( i ), r.values [ i ] / r.calls );
+			else fprintf ( out, ", \"%s_per_call\": null", counters.name ( i ) );
+		}
+		fprintf ( out, " }%s\n", ( k + 1 < results.size ( ) ) ? "," : "" );
+	}
+	fprintf ( out, "  ]\n}\n" );
+	if ( outPath ) fclose ( out );
+
+	return 0;
+}
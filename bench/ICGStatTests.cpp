@@ -0,0 +1,552 @@
+/**
+ * Statistical test battery for ICG output, run in parallel on all cores.
+ *
+ * Every test draws its samples from its own stretch of one ICG sequence; each thread of a test starts
+ * at its own offset, reached with ICG :: jump ( ), so the threads together test one long run of the
+ * sequence instead of unrelated seeds. The tests are
+ *
+ *  - equidistribution: chi-square of rand ( ) over 4096 cells
+ *  - serial pairs:     chi-square of non-overlapping pairs over 64 x 64 cells
+ *  - serial triples:   chi-square of non-overlapping triples over 16 x 16 x 16 cells
+ *  - gap:              chi-square of the gap lengths between values in the lowest quarter
+ *  - runs up:          chi-square of the lengths of ascending runs (the value ending a run is skipped,
+ *                      so the lengths are independent, Knuth's variant)
+ *  - birthday spacings: duplicate spacings among m sorted values, Poisson with mean m^3 / ( 4 p )
+ *  - collision:        collisions of n balls thrown into 2^20 urns, compared with the exact expectation
+ *  - KS rand01:        Kolmogorov-Smirnov of rand01 ( ), measured on a 2^16 cell histogram
+ *  - KS normal:        the same for Phi ( randStdNorm ( ) )
+ *  - moments:          mean and the second to fourth moments of randStdNorm ( ) as z-scores
+ *
+ * Cell probabilities are computed from the exact sizes of the cells in 0, 1, ..., p-1, so the tests stay
+ * unbiased at sample counts where the rounding of a floating point mapping would show up.
+ * Each test reports its statistic, p-value, number of values drawn, and values per second.
+ *
+ * Note that the period of an ICG is at most p: with the 24 bit default prime of ICGStatic, large runs
+ * repeat the sequence and should be done with a larger prime.
+ *
+ * Build and run from the repository root:
+ *
+ * 	g++ -O2 -std=c++11 -pthread -I. bench/ICGStatTests.cpp ICG.cpp -o icg-stattests
+ * 	./icg-stattests [--samples N] [--threads N] [--p P --a A --b B] [--seed S]
+ *
+ * --samples sets the number of values drawn per test (default 10000000). The default generator uses the
+ * prime 2^31 - 1.
+ */
+
+#include "ICG.h"
+#include <math.h> // using: erfc ( ), exp ( ), log ( ), lgamma ( ), sqrt ( )
+#include <stdio.h> // using: printf ( ), fprintf ( )
+#include <stdlib.h> // using: strtoull ( )
+#include <string.h> // using: strcmp ( )
+#include <algorithm> // using: std::sort ( )
+#include <chrono> // using: std::chrono::steady_clock
+#include <string> // using: std::string
+#include <thread> // using: std::thread
+#include <vector> // using: std::vector
+
+namespace {
+
+struct Config {
+	unsigned long p, a, b, seed;
+	unsigned long long samples;
+	unsigned threads;
+	unsigned long long stride;	// distance in the sequence between consecutive thread segments
+};
+
+struct Result {
+	std :: string name;
+	double statistic;
+	double pValue;
+	unsigned long long draws;
+	double seconds;
+};
+
+const unsigned NUM_SLOTS = 10;	// number of test runs that get their own stretch of the sequence
+
+typedef unsigned long long ull;
+
+#if defined ( __SIZEOF_INT128__ )
+typedef unsigned __int128 wide_t;
+#else
+typedef unsigned long long wide_t;	// exact for p * cells < 2^64
+#endif
+
+/**
+ * Returns the cell of x when 0, 1, ..., p-1 is split into cells nearly equal parts.
+ */
+inline ull cellOf ( ull x, ull cells, ull p ) { return ( ull ) ( ( wide_t ) x * cells / p ); }
+
+/**
+ * Returns the number of values x < p with cellOf ( x, cells, p ) == c.
+ */
+ull cellSize ( ull c, ull cells, ull p ) {
+	ull hi = ( ull ) ( ( ( wide_t ) ( c + 1 ) * p + cells - 1 ) / cells );
+	ull lo = ( ull ) ( ( ( wide_t ) c * p + cells - 1 ) / cells );
+	return hi - lo;
+}
+
+
+/**
+ * Regularized upper incomplete gamma function Q ( s, x ).
+ */
+double gammaQ ( double s, double x ) {
+	if ( x <= 0.0 ) return 1.0;
+	double lnPrefix = s * log ( x ) - x - lgamma ( s );
+	if ( x < s + 1.0 ) {
+		// series for P ( s, x )
+		double term = 1.0 / s, sum = term;
+		for ( int n = 1; n < 1000000; n++ ) {
+			term *= x / ( s + n );
+			sum += term;
+			if ( term < sum * 1e-15 ) break;
+		}
+		return 1.0 - sum * exp ( lnPrefix );
+	}
+	// continued fraction for Q ( s, x ), modified Lentz
+	double bb = x + 1.0 - s, c = 1e300, d = 1.0 / bb, h = d;
+	for ( int n = 1; n < 1000000; n++ ) {
+		double an = -n * ( n - s );
+		bb += 2.0;
+		d = an * d + bb;
+		if ( fabs ( d ) < 1e-300 ) d = 1e-300;
+		c = bb + an / c;
+		if ( fabs ( c ) < 1e-300 ) c = 1e-300;
+		d = 1.0 / d;
+		double delta = d * c;
+		h *= delta;
+		if ( fabs ( delta - 1.0 ) < 1e-15 ) break;
+	}
+	return exp ( lnPrefix ) * h;
+}
+
+double chiSquarePValue ( double chi2, double df ) { return gammaQ ( df / 2.0, chi2 / 2.0 ); }
+
+double normalPValue ( double z ) { return erfc ( fabs ( z ) / sqrt ( 2.0 ) ); }
+
+/**
+ * Two-sided p-value of an observed count y of a Poisson variable with the given mean.
+ */
+double poissonPValue ( double y, double mean ) {
+	double le = gammaQ ( y + 1.0, mean );				// P ( Y <= y )
+	double ge = ( y < 1.0 ) ? 1.0 : 1.0 - gammaQ ( y, mean );	// P ( Y >= y )
+	double p = 2.0 * ( le < ge ? le : ge );
+	return p < 1.0 ? p : 1.0;
+}
+
+/**
+ * Kolmogorov distribution P ( K > lambda ).
+ */
+double kolmogorovPValue ( double lambda ) {
+	if ( lambda < 0.2 ) return 1.0;
+	double sum = 0.0;
+	for ( int j = 1; j <= 100; j++ ) {
+		double term = exp ( -2.0 * j * j * lambda * lambda );
+		sum += ( j & 1 ) ? term : -term;
+		if ( term < 1e-17 ) break;
+	}
+	return 2.0 * sum;
+}
+
+/**
+ * Chi-square statistic of observed counts against expected probabilities; categories with an expected
+ * count below 5 are merged into the following one.
+ */
+double chiSquare ( const std :: vector < ull > & observed, const std :: vector < double > & prob, double & df ) {
+	ull total = 0;
+	for ( size_t i = 0; i < observed.size ( ); i++ ) total += observed [ i ];
+
+	double chi2 = 0.0, obs = 0.0, exp = 0.0;
+	int categories = 0;
+	for ( size_t i = 0; i < observed.size ( ); i++ ) {
+		obs += observed [ i ];
+		exp += prob [ i ] * total;
+		if ( exp >= 5.0 || i + 1 == observed.size ( ) ) {
+			if ( exp > 0.0 ) {
+				chi2 += ( obs - exp ) * ( obs - exp ) / exp;
+				categories++;
+			}
+			obs = exp = 0.0;
+		}
+	}
+	df = categories - 1;
+	return chi2;
+}
+
+
+/**
+ * Runs body ( gen, items, acc ) on cfg.threads threads. Thread t gets items / threads of the items
+ * and a generator positioned at its own segment of the test's stretch of the sequence.
+ */
+template < class Acc, class Body >
+double runThreads ( const Config & cfg, unsigned slot, ull items, std :: vector < Acc > & accs, Body body ) {
+	std :: vector < std :: thread > workers;
+	std :: chrono :: steady_clock :: time_point start = std :: chrono :: steady_clock :: now ( );
+
+	for ( unsigned t = 0; t < cfg.threads; t++ ) {
+		ull share = items / cfg.threads + ( t < items % cfg.threads ? 1 : 0 );
+		workers.push_back ( std :: thread ( [ &cfg, &accs, &body, slot, share, t ] ( ) {
+			ICG gen ( cfg.p, cfg.a, cfg.b, cfg.seed );
+			gen.jump ( ( ( ull ) slot * cfg.threads + t ) * cfg.stride );
+			body ( gen, share, accs [ t ] );
+		} ) );
+	}
+	for ( unsigned t = 0; t < cfg.threads; t++ ) workers [ t ].join ( );
+
+	std :: chrono :: duration < double > elapsed = std :: chrono :: steady_clock :: now ( ) - start;
+	return elapsed.count ( );
+}
+
+struct Counts {
+	std :: vector < ull > counts;
+	ull draws;
+	Counts ( ) : draws ( 0 ) { }
+};
+
+/**
+ * Sums the per-thread counts into accs [ 0 ].
+ */
+void mergeCounts ( std :: vector < Counts > & accs ) {
+	for ( size_t t = 1; t < accs.size ( ); t++ ) {
+		for ( size_t i = 0; i < accs [ 0 ].counts.size ( ); i++ ) accs [ 0 ].counts [ i ] += accs [ t ].counts [ i ];
+		accs [ 0 ].draws += accs [ t ].draws;
+	}
+}
+
+Result chiSquareResult ( const char * name, std :: vector < Counts > & accs, const std :: vector < double > & prob, double seconds ) {
+	mergeCounts ( accs );
+	double df;
+	double chi2 = chiSquare ( accs [ 0 ].counts, prob, df );
+	Result r = { name, chi2, chiSquarePValue ( chi2, df ), accs [ 0 ].draws, seconds };
+	return r;
+}
+
+
+/**
+ * Chi-square test of d-tuples of consecutive values over cells^d cells.
+ */
+Result serialTest ( const Config & cfg, unsigned slot, const char * name, unsigned d, ull cells ) {
+	ull total = 1;
+	for ( unsigned i = 0; i < d; i++ ) total *= cells;
+
+	std :: vector < Counts > accs ( cfg.threads );
+	for ( unsigned t = 0; t < cfg.threads; t++ ) accs [ t ].counts.assign ( total, 0 );
+
+	double seconds = runThreads ( cfg, slot, cfg.samples / d, accs, [ d, cells ] ( ICG & gen, ull n, Counts & acc ) {
+		const ull p = gen.get_p ( );
+		for ( ull i = 0; i < n; i++ ) {
+			ull index = 0;
+			for ( unsigned k = 0; k < d; k++ ) index = index * cells + cellOf ( gen.rand ( ), cells, p );
+			acc.counts [ index ]++;
+		}
+		acc.draws = n * d;
+	} );
+
+	std :: vector < double > size ( cells ), prob ( total );
+	for ( ull c = 0; c < cells; c++ ) size [ c ] = ( double ) cellSize ( c, cells, cfg.p ) / cfg.p;
+	for ( ull index = 0; index < total; index++ ) {
+		double pr = 1.0;
+		for ( ull rest = index, k = 0; k < d; k++, rest /= cells ) pr *= size [ rest % cells ];
+		prob [ index ] = pr;
+	}
+	return chiSquareResult ( name, accs, prob, seconds );
+}
+
+/**
+ * Gap test: lengths of the runs of values >= g between values < g, with g = ceil ( p / 4 ).
+ */
+Result gapTest ( const Config & cfg, unsigned slot ) {
+	const unsigned T = 24;	// lengths >= T share the last category
+	const ull g = ( cfg.p + 3 ) / 4;
+
+	std :: vector < Counts > accs ( cfg.threads );
+	for ( unsigned t = 0; t < cfg.threads; t++ ) accs [ t ].counts.assign ( T + 1, 0 );
+
+	const double q = ( double ) g / cfg.p;
+	double seconds = runThreads ( cfg, slot, ( ull ) ( cfg.samples * q ), accs, [ g ] ( ICG & gen, ull n, Counts & acc ) {
+		ull draws = 0;
+		for ( ull i = 0; i < n; i++ ) {
+			unsigned len = 0;
+			while ( gen.rand ( ) >= g ) len++;
+			draws += len + 1;
+			acc.counts [ len < T ? len : T ]++;
+		}
+		acc.draws = draws;
+	} );
+
+	std :: vector < double > prob ( T + 1 );
+	for ( unsigned r = 0; r < T; r++ ) prob [ r ] = q * pow ( 1.0 - q, ( double ) r );
+	prob [ T ] = pow ( 1.0 - q, ( double ) T );
+	return chiSquareResult ( "gap", accs, prob, seconds );
+}
+
+/**
+ * Runs-up test with independent run lengths: P ( length = k ) = k / ( k + 1 ) !.
+ */
+Result runsUpTest ( const Config & cfg, unsigned slot ) {
+	const unsigned T = 7;	// lengths >= T share the last category
+
+	std :: vector < Counts > accs ( cfg.threads );
+	for ( unsigned t = 0; t < cfg.threads; t++ ) accs [ t ].counts.assign ( T + 1, 0 );
+
+	// a run and its skipped successor take e draws on average
+	double seconds = runThreads ( cfg, slot, ( ull ) ( cfg.samples / exp ( 1.0 ) ), accs, [ ] ( ICG & gen, ull n, Counts & acc ) {
+		ull draws = 0;
+		for ( ull i = 0; i < n; i++ ) {
+			unsigned long prev = gen.rand ( ), cur;
+			unsigned len = 1;
+			while ( ( cur = gen.rand ( ) ) > prev ) {
+				prev = cur;
+				len++;
+			}
+			draws += len + 1;
+			acc.counts [ len < T ? len : T ]++;
+		}
+		acc.draws = draws;
+	} );
+
+	std :: vector < double > prob ( T + 1, 0.0 );
+	double fact = 1.0;	// k !
+	for ( unsigned k = 1; k < T; k++ ) {
+		fact *= k;
+		prob [ k ] = k / ( fact * ( k + 1 ) );
+	}
+	prob [ T ] = 1.0 / ( fact * T );
+	return chiSquareResult ( "runs up", accs, prob, seconds );
+}
+
+/**
+ * Birthday spacings: m birthdays in p days, number of duplicate values among the sorted spacings.
+ */
+Result birthdayTest ( const Config & cfg, unsigned slot ) {
+	ull m = ( ull ) cbrt ( 16.0 * cfg.p );	// mean about 4 duplicates per repetition
+	if ( m > ( 1ULL << 20 ) ) m = 1ULL << 20;
+	if ( m < 2 ) m = 2;
+	const double lambda = ( double ) m * m * m / ( 4.0 * cfg.p );
+	const ull reps = cfg.samples / m > 0 ? cfg.samples / m : 1;
+
+	std :: vector < Counts > accs ( cfg.threads );
+	for ( unsigned t = 0; t < cfg.threads; t++ ) accs [ t ].counts.assign ( 2, 0 );	// duplicates, repetitions
+
+	double seconds = runThreads ( cfg, slot, reps, accs, [ m ] ( ICG & gen, ull n, Counts & acc ) {
+		std :: vector < ull > days ( m );
+		for ( ull i = 0; i < n; i++ ) {
+			for ( ull j = 0; j < m; j++ ) days [ j ] = gen.rand ( );
+			std :: sort ( days.begin ( ), days.end ( ) );
+			for ( ull j = m - 1; j > 0; j-- ) days [ j ] -= days [ j - 1 ];
+			std :: sort ( days.begin ( ) + 1, days.end ( ) );
+			for ( ull j = 2; j < m; j++ ) acc.counts [ 0 ] += ( days [ j ] == days [ j - 1 ] );
+		}
+		acc.counts [ 1 ] = n;
+		acc.draws = n * m;
+	} );
+
+	mergeCounts ( accs );
+	double y = ( double ) accs [ 0 ].counts [ 0 ], mean = lambda * accs [ 0 ].counts [ 1 ];
+	Result r = { "birthday spacings", y, poissonPValue ( y, mean ), accs [ 0 ].draws, seconds };
+	return r;
+}
+
+/**
+ * Collision test: n balls into m urns per repetition, total number of balls landing in an occupied urn.
+ */
+Result collisionTest ( const Config & cfg, unsigned slot ) {
+	const ull m = cfg.p < ( 1ULL << 20 ) ? cfg.p : ( 1ULL << 20 );
+	const ull n = m / 64 > 0 ? m / 64 : 1;
+	const ull reps = cfg.samples / n > 0 ? cfg.samples / n : 1;
+
+	std :: vector < Counts > accs ( cfg.threads );
+	for ( unsigned t = 0; t < cfg.threads; t++ ) accs [ t ].counts.assign ( 2, 0 );	// collisions, repetitions
+
+	double seconds = runThreads ( cfg, slot, reps, accs, [ m, n ] ( ICG & gen, ull r, Counts & acc ) {
+		const ull p = gen.get_p ( );
+		std :: vector < unsigned char > urns ( m, 0 );
+		std :: vector < ull > used ( n );
+		for ( ull i = 0; i < r; i++ ) {
+			for ( ull j = 0; j < n; j++ ) {
+				ull u = cellOf ( gen.rand ( ), m, p );
+				acc.counts [ 0 ] += urns [ u ];
+				urns [ u ] = 1;
+				used [ j ] = u;
+			}
+			for ( ull j = 0; j < n; j++ ) urns [ used [ j ] ] = 0;
+		}
+		acc.counts [ 1 ] = r;
+		acc.draws = r * n;
+	} );
+
+	// E [ collisions ] = n - m + sum over urns of P ( urn stays empty ); the urns have two sizes
+	double emptySum = 0.0;
+	ull small = cfg.p / m, numLarge = cfg.p % m;
+	emptySum += ( m - numLarge ) * exp ( n * log1p ( - ( double ) small / cfg.p ) );
+	if ( numLarge ) emptySum += numLarge * exp ( n * log1p ( - ( double ) ( small + 1 ) / cfg.p ) );
+	double expected = ( double ) n - ( double ) m + emptySum;
+
+	mergeCounts ( accs );
+	double y = ( double ) accs [ 0 ].counts [ 0 ], mean = expected * accs [ 0 ].counts [ 1 ];
+	Result r = { "collision", y, poissonPValue ( y, mean ), accs [ 0 ].draws, seconds };
+	return r;
+}
+
+/**
+ * Kolmogorov-Smirnov test of uniform values in [ 0, 1 ) produced by sample ( gen ), measured at the
+ * edges of a 2^16 cell histogram. Compared to the exact statistic this underestimates D by a relative
+ * amount of order 2^-8, which does not matter for a test at this sample size.
+ */
+template < class Sample >
+Result ksTest ( const Config & cfg, unsigned slot, const char * name, Sample sample ) {
+	const ull CELLS = 1 << 16;
+
+	std :: vector < Counts > accs ( cfg.threads );
+	for ( unsigned t = 0; t < cfg.threads; t++ ) accs [ t ].counts.assign ( CELLS, 0 );
+
+	double seconds = runThreads ( cfg, slot, cfg.samples, accs, [ &sample, CELLS ] ( ICG & gen, ull n, Counts & acc ) {
+		for ( ull i = 0; i < n; i++ ) {
+			double u = sample ( gen );
+			ull c = ( ull ) ( u * CELLS );
+			acc.counts [ c < CELLS ? c : CELLS - 1 ]++;
+		}
+		acc.draws = n;
+	} );
+
+	mergeCounts ( accs );
+	const double total = ( double ) accs [ 0 ].draws;
+	double d = 0.0, cum = 0.0;
+	for ( ull c = 0; c < CELLS; c++ ) {
+		cum += accs [ 0 ].counts [ c ];
+		double diff = fabs ( cum / total - ( double ) ( c + 1 ) / CELLS );
+		if ( diff > d ) d = diff;
+	}
+	double sqrtN = sqrt ( total );
+	Result r = { name, d, kolmogorovPValue ( ( sqrtN + 0.12 + 0.11 / sqrtN ) * d ), accs [ 0 ].draws, seconds };
+	return r;
+}
+
+/**
+ * z-scores of the sample moments E [ x^k ], k = 1 .. 4, of randStdNorm ( ).
+ */
+void momentsTest ( const Config & cfg, unsigned slot, std :: vector < Result > & results ) {
+	struct Sums {
+		double s [ 4 ];
+		ull draws;
+		Sums ( ) : draws ( 0 ) { s [ 0 ] = s [ 1 ] = s [ 2 ] = s [ 3 ] = 0.0; }
+	};
+	std :: vector < Sums > accs ( cfg.threads );
+
+	double seconds = runThreads ( cfg, slot, cfg.samples, accs, [ ] ( ICG & gen, ull n, Sums & acc ) {
+		// partial sums per block keep the rounding error independent of n
+		const ull BLOCK = 4096;
+		for ( ull done = 0; done < n; ) {
+			double s1 = 0.0, s2 = 0.0, s3 = 0.0, s4 = 0.0;
+			ull block = ( n - done < BLOCK ) ? n - done : BLOCK;
+			for ( ull i = 0; i < block; i++ ) {
+				double x = gen.randStdNorm ( ), x2 = x * x;
+				s1 += x;
+				s2 += x2;
+				s3 += x2 * x;
+				s4 += x2 * x2;
+			}
+			acc.s [ 0 ] += s1; acc.s [ 1 ] += s2; acc.s [ 2 ] += s3; acc.s [ 3 ] += s4;
+			done += block;
+		}
+		acc.draws = n;
+	} );
+
+	double s [ 4 ] = { 0.0, 0.0, 0.0, 0.0 };
+	ull draws = 0;
+	for ( unsigned t = 0; t < cfg.threads; t++ ) {
+		for ( int k = 0; k < 4; k++ ) s [ k ] += accs [ t ].s [ k ];
+		draws += accs [ t ].draws;
+	}
+
+	// E [ x^k ] and Var [ x^k ] of a standard normal
+	const double mean [ 4 ] = { 0.0, 1.0, 0.0, 3.0 };
+	const double var [ 4 ] = { 1.0, 2.0, 15.0, 96.0 };
+	const char * names [ 4 ] = { "moments E[x]", "moments E[x^2]", "moments E[x^3]", "moments E[x^4]" };
+	for ( int k = 0; k < 4; k++ ) {
+		double z = ( s [ k ] / draws - mean [ k ] ) / sqrt ( var [ k ] / draws );
+		Result r = { names [ k ], z, normalPValue ( z ), draws, seconds };
+		results.push_back ( r );
+	}
+}
+
+double uniformSample ( ICG & gen ) { return gen.rand01 ( ); }
+
+double normalSample ( ICG & gen ) { return 0.5 * erfc ( -gen.randStdNorm ( ) / sqrt ( 2.0 ) ); }
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	Config cfg;
+	cfg.p = 2147483647UL;
+	cfg.a = 16807UL;
+	cfg.b = 1UL;
+	cfg.seed = 12345UL;
+	cfg.samples = 10000000ULL;
+	cfg.threads = std :: thread :: hardware_concurrency ( );
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--samples" ) == 0 && i + 1 < argc ) cfg.samples = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--threads" ) == 0 && i + 1 < argc ) cfg.threads = ( unsigned ) strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--p" ) == 0 && i + 1 < argc ) cfg.p = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--a" ) == 0 && i + 1 < argc ) cfg.a = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--b" ) == 0 && i + 1 < argc ) cfg.b = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--seed" ) == 0 && i + 1 < argc ) cfg.seed = strtoul ( argv [ ++i ], 0, 10 );
+		else {
+			fprintf ( stderr, "usage: %s [--samples N] [--threads N] [--p P --a A --b B] [--seed S]\n", argv [ 0 ] );
+			return 2;
+		}
+	}
+	if ( cfg.threads == 0 ) cfg.threads = 1;
+	if ( cfg.samples < 1000 ) cfg.samples = 1000;
+
+	ICG check ( cfg.p, cfg.a, cfg.b, cfg.seed % cfg.p );
+	if ( !check.isValid ( ) ) {
+		fprintf ( stderr, "invalid generator parameters p=%lu a=%lu b=%lu\n", cfg.p, cfg.a, cfg.b );
+		return 1;
+	}
+	cfg.seed %= cfg.p;
+
+	// spread the thread segments of all tests evenly over the period bound p
+	cfg.stride = cfg.p / ( ( ull ) NUM_SLOTS * cfg.threads );
+	if ( cfg.stride == 0 ) cfg.stride = 1;
+	if ( cfg.samples / cfg.threads > cfg.stride ) {
+		fprintf ( stderr, "note: %llu values per thread and test exceed the segment length %llu of p=%lu; "
+				  "segments overlap, use a larger prime for runs of this size\n",
+				  cfg.samples / cfg.threads, cfg.stride, cfg.p );
+	}
+
+	fprintf ( stderr, "ICG p=%lu a=%lu b=%lu seed=%lu, %llu values per test, %u threads\n",
+			  cfg.p, cfg.a, cfg.b, cfg.seed, cfg.samples, cfg.threads );
+
+	std :: vector < Result > results;
+	unsigned slot = 0;
+	results.push_back ( serialTest ( cfg, slot++, "equidistribution", 1, 4096 ) );
+	results.push_back ( serialTest ( cfg, slot++, "serial pairs", 2, 64 ) );
+	results.push_back ( serialTest ( cfg, slot++, "serial triples", 3, 16 ) );
+	results.push_back ( gapTest ( cfg, slot++ ) );
+	results.push_back ( runsUpTest ( cfg, slot++ ) );
+	results.push_back ( birthdayTest ( cfg, slot++ ) );
+	results.push_back ( collisionTest ( cfg, slot++ ) );
+	results.push_back ( ksTest ( cfg, slot++, "KS rand01", uniformSample ) );
+	results.push_back ( ksTest ( cfg, slot++, "KS randStdNorm", normalSample ) );
+	momentsTest ( cfg, slot++, results );
+
+	printf ( "%-20s %14s %12s %10s %14s\n", "test", "statistic", "p-value", "values", "values/sec" );
+	ull totalDraws = 0;
+	double totalSeconds = 0.0;
+	int suspect = 0;
+	for ( size_t i = 0; i < results.size ( ); i++ ) {
+		const Result & r = results [ i ];
+		bool bad = r.pValue < 1e-3;
+		suspect += bad;
+		printf ( "%-20s %14.4f %12.6f %10llu %14.0f%s\n", r.name.c_str ( ), r.statistic, r.pValue, r.draws, r.draws / r.seconds, bad ? "  SUSPECT" : "" );
+		// the moment lines share one run
+		if ( r.name.compare ( 0, 8, "moments " ) != 0 || r.name == "moments E[x]" ) {
+			totalDraws += r.draws;
+			totalSeconds += r.seconds;
+		}
+	}
+	printf ( "total %llu values in %.2f s, %.0f values/sec, %d suspect p-value(s)\n", totalDraws, totalSeconds, totalDraws / totalSeconds, suspect );
+
+	return suspect ? 1 : 0;
+}
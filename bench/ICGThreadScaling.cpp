@@ -0,0 +1,161 @@
+/**
+ * Aggregate throughput of ICG generation from 1 to N threads.
+ *
+ * Compares the ways an application can hand out generators to its threads:
+ *
+ *  - static:     all threads call ICGStatic :: rand01 ( ). This is a data race on the shared state;
+ *                it is measured to show the cost of the cache line bouncing between cores,
+ *                and the outputs are not usable.
+ *  - mutex:      one shared ICG protected by a std :: mutex, the correct version of the above.
+ *  - packed:     one ICG per thread, stored next to each other in a std :: vector, so neighbouring
+ *                generators share cache lines (false sharing).
+ *  - padded:     one ICG per thread, each aligned to its own cache line.
+ *  - threadlocal: one thread_local ICG per thread, allocated by the thread itself.
+ *
+ * Every configuration runs for a fixed time per thread count; the result is a CSV table
+ * (variant, threads, total calls per second, calls per second per thread, speedup over 1 thread)
+ * that can be plotted directly.
+ *
+ * Build and run from the repository root:
+ *
+ * 	g++ -O2 -std=c++17 -pthread -I. bench/ICGThreadScaling.cpp ICG.cpp ICGStatic.cpp -o icg-threads
+ * 	./icg-threads [--threads N] [--seconds S] [--out scaling.csv]
+ */
+
+#include "ICG.h"
+#include "ICGStatic.h"
+#include <stdio.h> // using: fprintf ( ), fopen ( )
+#include <stdlib.h> // using: strtoul ( ), strtod ( )
+#include <string.h> // using: strcmp ( )
+#include <atomic> // using: std::atomic
+#include <chrono> // using: std::chrono::steady_clock
+#include <mutex> // using: std::mutex
+#include <thread> // using: std::thread
+#include <vector> // using: std::vector
+
+namespace {
+
+const unsigned long P = 15485863, A = 213, B = 64;
+
+struct alignas ( 64 ) PaddedICG {
+	ICG icg;
+	explicit PaddedICG ( unsigned long seed ) : icg ( P, A, B, seed ) { }
+};
+
+// written once per run by the main thread, so the generated values cannot be optimized away
+volatile double sinkDouble;
+
+/**
+ * Runs body ( thread ) on the given number of threads for the given time and returns the total call rate.
+ *
+ * body performs one call and returns the generated value, and is invoked in batches, so checking the stop
+ * flag costs nothing measurable. Each thread adds the values in a local accumulator and publishes it once
+ * after the timed loop, so the only shared writes are those of the variant being measured.
+ */
+template < class Body >
+double run ( unsigned threads, double seconds, Body body ) {
+	std :: atomic < bool > go ( false ), stop ( false );
+	std :: atomic < unsigned > ready ( 0 );
+	std :: vector < unsigned long long > calls ( threads * 8, 0 );	// one counter per cache line
+	std :: vector < double > sums ( threads * 8, 0.0 );
+	std :: vector < std :: thread > workers;
+
+	for ( unsigned t = 0; t < threads; t++ ) {
+		workers.push_back ( std :: thread ( [ &, t ] ( ) {
+			ready++;
+			while ( !go.load ( ) ) { }
+			unsigned long long n = 0;
+			double sum = 0.0;
+			while ( !stop.load ( std :: memory_order_relaxed ) ) {
+				for ( int i = 0; i < 256; i++ ) sum += body ( t );
+				n += 256;
+			}
+			calls [ t * 8 ] = n;
+			sums [ t * 8 ] = sum;
+		} ) );
+	}
+
+	while ( ready.load ( ) < threads ) { }
+	std :: chrono :: steady_clock :: time_point start = std :: chrono :: steady_clock :: now ( );
+	go = true;
+	std :: this_thread :: sleep_for ( std :: chrono :: duration < double > ( seconds ) );
+	stop = true;
+	for ( unsigned t = 0; t < threads; t++ ) workers [ t ].join ( );
+	std :: chrono :: duration < double > elapsed = std :: chrono :: steady_clock :: now ( ) - start;
+
+	unsigned long long total = 0;
+	double sum = 0.0;
+	for ( unsigned t = 0; t < threads; t++ ) {
+		total += calls [ t * 8 ];
+		sum += sums [ t * 8 ];
+	}
+	sinkDouble = sum;
+	return total / elapsed.count ( );
+}
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	unsigned maxThreads = std :: thread :: hardware_concurrency ( );
+	double seconds = 0.5;
+	const char * outPath = 0;
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--threads" ) == 0 && i + 1 < argc ) maxThreads = ( unsigned ) strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--seconds" ) == 0 && i + 1 < argc ) seconds = strtod ( argv [ ++i ], 0 );
+		else if ( strcmp ( argv [ i ], "--out" ) == 0 && i + 1 < argc ) outPath = argv [ ++i ];
+		else {
+			fprintf ( stderr, "usage: %s [--threads N] [--seconds S] [--out scaling.csv]\n", argv [ 0 ] );
+			return 2;
+		}
+	}
+	if ( maxThreads == 0 ) maxThreads = 1;
+
+	FILE * out = outPath ? fopen ( outPath, "w" ) : stdout;
+	if ( !out ) {
+		fprintf ( stderr, "cannot open %s\n", outPath );
+		return 1;
+	}
+	fprintf ( out, "variant,threads,calls_per_sec,calls_per_sec_per_thread,speedup\n" );
+
+	const char * variants [ ] = { "static", "mutex", "packed", "padded", "threadlocal" };
+	for ( size_t v = 0; v < sizeof ( variants ) / sizeof ( variants [ 0 ] ); v++ ) {
+		double base = 0.0;
+		for ( unsigned threads = 1; threads <= maxThreads; threads++ ) {
+			double rate = 0.0;
+
+			if ( v == 0 ) {
+				rate = run ( threads, seconds, [ ] ( unsigned ) { return ICGStatic :: rand01 ( ); } );
+			} else if ( v == 1 ) {
+				ICG shared ( P, A, B, 12345 );
+				std :: mutex lock;
+				rate = run ( threads, seconds, [ & ] ( unsigned ) {
+					std :: lock_guard < std :: mutex > guard ( lock );
+					return shared.rand01 ( );
+				} );
+			} else if ( v == 2 ) {
+				std :: vector < ICG > gens;
+				for ( unsigned t = 0; t < threads; t++ ) gens.push_back ( ICG ( P, A, B, 1000 + t ) );
+				rate = run ( threads, seconds, [ & ] ( unsigned t ) { return gens [ t ].rand01 ( ); } );
+			} else if ( v == 3 ) {
+				std :: vector < PaddedICG > gens;
+				gens.reserve ( threads );
+				for ( unsigned t = 0; t < threads; t++ ) gens.push_back ( PaddedICG ( 1000 + t ) );
+				rate = run ( threads, seconds, [ & ] ( unsigned t ) { return gens [ t ].icg.rand01 ( ); } );
+			} else {
+				rate = run ( threads, seconds, [ ] ( unsigned t ) {
+					thread_local ICG local ( P, A, B, 1000 + t );
+					return local.rand01 ( );
+				} );
+			}
+
+			if ( threads == 1 ) base = rate;
+			fprintf ( out, "%s,%u,%.0f,%.0f,%.3f\n", variants [ v ], threads, rate, rate / threads, base > 0 ? rate / base : 0.0 );
+			fflush ( out );
+			fprintf ( stderr, "%-12s %3u threads %14.0f calls/s\n", variants [ v ], threads, rate );
+		}
+	}
+
+	if ( outPath ) fclose ( out );
+	return 0;
+}
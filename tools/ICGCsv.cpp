@@ -0,0 +1,125 @@
+/**
+ * icg-csv: writes a synthetic CSV dataset generated with all cores (see ICGCsv.h).
+ *
+ * 	icg-csv --out FILE --rows N --column SPEC [--column SPEC ...] [--threads N] [--chunk-rows N]
+ * 	        [--p P --a A --b B] [--seed S]
+ *
+ * A column SPEC is one of
+ *
+ * 	NAME:id                      row number
+ * 	NAME:int:LO:HI               uniform integer in LO..HI
+ * 	NAME:real:LO:HI[:DIGITS]     uniform real in [ LO, HI )
+ * 	NAME:normal:MU:SIGMA[:DIGITS] normal real
+ * 	NAME:cat:A|B|C               uniform pick of one of the listed categories
+ *
+ * e.g. icg-csv --out people.csv --rows 100000000 --column id:id --column age:int:18:90
+ *              --column score:normal:100:15:2 --column color:cat:red|green|blue
+ *
+ * Build from the repository root:
+ *
+ * 	g++ -O2 -std=c++17 -pthread -I. tools/ICGCsv.cpp ICGCsv.cpp ICG.cpp -o icg-csv
+ */
+
+#include "ICGCsv.h"
+#include <stdio.h> // using: printf ( ), fprintf ( )
+#include <stdlib.h> // using: strtoul ( ), strtoull ( ), strtoll ( ), strtod ( )
+#include <string.h> // using: strcmp ( )
+#include <chrono> // using: std::chrono::steady_clock
+#include <string> // using: std::string
+#include <sys/stat.h> // using: stat ( )
+#include <vector> // using: std::vector
+
+namespace {
+
+std :: vector < std :: string > split ( const std :: string & s, char sep ) {
+	std :: vector < std :: string > parts;
+	size_t start = 0;
+	for ( size_t i = 0; i <= s.size ( ); i++ ) {
+		if ( i == s.size ( ) || s [ i ] == sep ) {
+			parts.push_back ( s.substr ( start, i - start ) );
+			start = i + 1;
+		}
+	}
+	return parts;
+}
+
+/**
+ * Adds the column described by spec to csv.
+ *
+ * @return False if the spec is malformed or rejected by ICGCsv.
+ */
+bool addColumn ( ICGCsv & csv, const std :: string & spec ) {
+	std :: vector < std :: string > f = split ( spec, ':' );
+	if ( f.size ( ) < 2 || f [ 0 ].empty ( ) ) return false;
+	const std :: string & name = f [ 0 ], & type = f [ 1 ];
+
+	if ( type == "id" && f.size ( ) == 2 ) {
+		csv.addId ( name );
+		return true;
+	}
+	if ( type == "int" && f.size ( ) == 4 ) {
+		return csv.addUniformInt ( name, strtoll ( f [ 2 ].c_str ( ), 0, 10 ), strtoll ( f [ 3 ].c_str ( ), 0, 10 ) );
+	}
+	if ( ( type == "real" || type == "normal" ) && ( f.size ( ) == 4 || f.size ( ) == 5 ) ) {
+		double x = strtod ( f [ 2 ].c_str ( ), 0 ), y = strtod ( f [ 3 ].c_str ( ), 0 );
+		int digits = ( f.size ( ) == 5 ) ? ( int ) strtol ( f [ 4 ].c_str ( ), 0, 10 ) : 6;
+		return ( type == "real" ) ? csv.addUniformReal ( name, x, y, digits ) : csv.addNormal ( name, x, y, digits );
+	}
+	if ( type == "cat" && f.size ( ) == 3 ) {
+		return csv.addCategory ( name, split ( f [ 2 ], '|' ) );
+	}
+	return false;
+}
+
+int usage ( const char * argv0 ) {
+	fprintf ( stderr, "usage: %s --out FILE --rows N --column SPEC [--column SPEC ...] [--threads N] [--chunk-rows N]\n"
+			  "       [--p P --a A --b B] [--seed S]\n"
+			  "SPEC: NAME:id | NAME:int:LO:HI | NAME:real:LO:HI[:DIGITS] | NAME:normal:MU:SIGMA[:DIGITS] | NAME:cat:A|B|C\n", argv0 );
+	return 2;
+}
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	unsigned long p = 2147483647UL, a = 16807UL, b = 1UL, seed = 12345UL;
+	unsigned long long rows = 0, chunkRows = ICGCsv :: DEFAULT_CHUNK_ROWS;
+	unsigned threads = 0;
+	const char * outPath = 0;
+	std :: vector < std :: string > specs;
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--out" ) == 0 && i + 1 < argc ) outPath = argv [ ++i ];
+		else if ( strcmp ( argv [ i ], "--rows" ) == 0 && i + 1 < argc ) rows = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--column" ) == 0 && i + 1 < argc ) specs.push_back ( argv [ ++i ] );
+		else if ( strcmp ( argv [ i ], "--threads" ) == 0 && i + 1 < argc ) threads = ( unsigned ) strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--chunk-rows" ) == 0 && i + 1 < argc ) chunkRows = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--p" ) == 0 && i + 1 < argc ) p = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--a" ) == 0 && i + 1 < argc ) a = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--b" ) == 0 && i + 1 < argc ) b = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--seed" ) == 0 && i + 1 < argc ) seed = strtoul ( argv [ ++i ], 0, 10 );
+		else return usage ( argv [ 0 ] );
+	}
+	if ( !outPath || specs.empty ( ) ) return usage ( argv [ 0 ] );
+
+	ICGCsv csv ( p, a, b, seed );
+	csv.setChunkRows ( ( size_t ) chunkRows );
+	for ( size_t i = 0; i < specs.size ( ); i++ ) {
+		if ( !addColumn ( csv, specs [ i ] ) ) {
+			fprintf ( stderr, "invalid column %s\n", specs [ i ].c_str ( ) );
+			return 2;
+		}
+	}
+
+	std :: chrono :: steady_clock :: time_point start = std :: chrono :: steady_clock :: now ( );
+	if ( !csv.write ( outPath, rows, threads ) ) {
+		fprintf ( stderr, "cannot write %s (invalid generator parameters or I/O error)\n", outPath );
+		return 1;
+	}
+	std :: chrono :: duration < double > elapsed = std :: chrono :: steady_clock :: now ( ) - start;
+
+	struct stat st;
+	double bytes = ( stat ( outPath, &st ) == 0 ) ? ( double ) st.st_size : 0.0;
+	printf ( "%s: %llu rows, %.0f bytes in %.2f s, %.0f rows/sec, %.1f MB/s\n", outPath, rows, bytes, elapsed.count ( ),
+			 rows / elapsed.count ( ), bytes / elapsed.count ( ) / 1e6 );
+	return 0;
+}
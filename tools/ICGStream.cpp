@@ -0,0 +1,366 @@
+/**
+ * icg-stream: writes raw ICG output to stdout or a file, as fast as the consumer can take it.
+ *
+ * Intended as a source for PractRand / TestU01 style tools (e.g. icg-stream | RNG_test stdin32) and for
+ * data loaders that read binary values. Output types:
+ *
+ *  - u32:    uniform 32 bit words (ICG :: fillBytes ( ), exactly uniform bits)
+ *  - double: ICG :: rand01 ( ) values
+ *  - normal: ICG :: randStdNorm ( ) values
+ *
+ * Values are written in native byte order without any framing.
+ *
+ * The output is a sequence of chunks. Chunk k is the next part of substream k % S, where substream j
+ * is the generator sequence starting at ICG :: jump ( j * ( p / S ) ), so the S substreams are disjoint
+ * stretches of the same sequence as long as each supplies less than p / S values. The output therefore
+ * depends on --streams but not on --threads; the number of threads is reduced to a divisor of the number
+ * of streams so every substream belongs to one thread.
+ *
+ * Chunks are produced into page aligned buffers by the generator threads and written in order by the
+ * main thread. If the output is a pipe, its buffer is resized to one chunk and the chunks are passed with
+ * vmsplice ( ), which hands the pages to the pipe instead of copying them; a buffer is reused only after
+ * the next chunk has fitted into the pipe, i.e. after the reader has consumed it. Otherwise consecutive
+ * finished chunks are written with one writev ( ) call.
+ *
+ * Build and run from the repository root:
+ *
+ * 	g++ -O2 -std=c++11 -pthread -I. tools/ICGStream.cpp ICG.cpp -o icg-stream
+ * 	./icg-stream [--type u32|double|normal] [--count N] [--out file] [--threads N] [--streams S]
+ * 	             [--chunk BYTES] [--p P --a A --b B] [--seed S]
+ *
+ * Without --count the output is endless. The default generator uses the prime 2^31 - 1.
+ */
+
+#include "ICG.h"
+#include <errno.h> // using: errno, EINTR, EPIPE
+#include <fcntl.h> // using: open ( ), fcntl ( ), vmsplice ( )
+#include <signal.h> // using: signal ( ), SIGPIPE
+#include <stdio.h> // using: fprintf ( ), perror ( )
+#include <stdlib.h> // using: strtoull ( ), posix_memalign ( ), free ( )
+#include <string.h> // using: strcmp ( )
+#include <sys/stat.h> // using: fstat ( ), S_ISFIFO
+#include <sys/uio.h> // using: writev ( ), struct iovec
+#include <unistd.h> // using: close ( )
+#include <atomic> // using: std::atomic
+#include <condition_variable> // using: std::condition_variable
+#include <mutex> // using: std::mutex
+#include <thread> // using: std::thread
+#include <vector> // using: std::vector
+
+namespace {
+
+typedef unsigned long long ull;
+
+enum ValueType { U32, DOUBLE, NORMAL };
+
+struct Config {
+	unsigned long p, a, b, seed;
+	ValueType type;
+	size_t valueSize;
+	ull count;		// values to write, 0 for endless
+	size_t chunkBytes;
+	unsigned threads, streams;
+};
+
+/**
+ * A chunk buffer and its hand-over state between a generator thread and the writer.
+ */
+struct Slot {
+	char * data;
+	size_t bytes;
+	bool full;
+	std :: mutex lock;
+	std :: condition_variable changed;
+};
+
+class Stream {
+	public:
+		Stream ( const Config & cfg ) : cfg ( cfg ), slots ( 2 * cfg.threads ), stop ( false ) {
+			for ( size_t i = 0; i < slots.size ( ); i++ ) {
+				void * mem = 0;
+				if ( posix_memalign ( &mem, 4096, cfg.chunkBytes ) != 0 ) mem = 0;
+				slots [ i ].data = ( char * ) mem;
+				slots [ i ].full = false;
+			}
+		}
+
+		~Stream ( ) {
+			for ( size_t i = 0; i < slots.size ( ); i++ ) free ( slots [ i ].data );
+		}
+
+		bool isValid ( ) const {
+			for ( size_t i = 0; i < slots.size ( ); i++ ) if ( !slots [ i ].data ) return false;
+			return true;
+		}
+
+		int run ( int fd );
+
+	private:
+		const Config & cfg;
+		std :: vector < Slot > slots;
+		std :: atomic < bool > stop;
+
+		ull chunkValues ( ) const { return cfg.chunkBytes / cfg.valueSize; }
+
+		/**
+		 * Returns the number of values in chunk k, 0 after the last chunk.
+		 */
+		ull valuesInChunk ( ull k ) const {
+			if ( cfg.count == 0 ) return chunkValues ( );
+			ull first = k * chunkValues ( );
+			if ( first >= cfg.count ) return 0;
+			return ( cfg.count - first < chunkValues ( ) ) ? cfg.count - first : chunkValues ( );
+		}
+
+		void produce ( unsigned t );
+		void fill ( ICG & gen, char * out, ull n ) const;
+		Slot & waitFull ( ull k );
+		void release ( ull k );
+		bool writeAll ( int fd, struct iovec * iov, int n );
+#if defined ( __linux__ )
+		bool spliceAll ( int fd, char * data, size_t bytes );
+#endif
+};
+
+void Stream :: fill ( ICG & gen, char * out, ull n ) const {
+	if ( cfg.type == U32 ) {
+		gen.fillBytes ( out, n * 4 );
+	} else if ( cfg.type == DOUBLE ) {
+		gen.fill01 ( ( double * ) out, n );
+	} else {
+		double * d = ( double * ) out;
+		for ( ull i = 0; i < n; i++ ) d [ i ] = gen.randStdNorm ( );
+	}
+}
+
+/**
+ * Generator thread t: produces the chunks k with k % threads == t, using one ICG per owned substream.
+ */
+void Stream :: produce ( unsigned t ) {
+	std :: vector < ICG > gens;
+	for ( unsigned j = t; j < cfg.streams; j += cfg.threads ) {
+		gens.push_back ( ICG ( cfg.p, cfg.a, cfg.b, cfg.seed ) );
+		gens.back ( ).jump ( ( ull ) j * ( cfg.p / cfg.streams ) );
+	}
+
+	for ( ull k = t; ; k += cfg.threads ) {
+		ull n = valuesInChunk ( k );
+		if ( n == 0 ) return;
+
+		Slot & slot = slots [ k % slots.size ( ) ];
+		{
+			std :: unique_lock < std :: mutex > guard ( slot.lock );
+			while ( slot.full && !stop ) slot.changed.wait ( guard );
+			if ( stop ) return;
+		}
+
+		// substream k % streams is gens [ ( k % streams ) / threads ], because threads divides streams
+		fill ( gens [ ( k % cfg.streams ) / cfg.threads ], slot.data, n );
+
+		std :: lock_guard < std :: mutex > guard ( slot.lock );
+		slot.bytes = n * cfg.valueSize;
+		slot.full = true;
+		slot.changed.notify_all ( );
+	}
+}
+
+Slot & Stream :: waitFull ( ull k ) {
+	Slot & slot = slots [ k % slots.size ( ) ];
+	std :: unique_lock < std :: mutex > guard ( slot.lock );
+	while ( !slot.full ) slot.changed.wait ( guard );
+	return slot;
+}
+
+void Stream :: release ( ull k ) {
+	Slot & slot = slots [ k % slots.size ( ) ];
+	std :: lock_guard < std :: mutex > guard ( slot.lock );
+	slot.full = false;
+	slot.changed.notify_all ( );
+}
+
+/**
+ * writev ( ) of all buffers, continuing after partial writes.
+ */
+bool Stream :: writeAll ( int fd, struct iovec * iov, int n ) {
+	while ( n > 0 ) {
+		ssize_t written = writev ( fd, iov, n );
+		if ( written < 0 ) {
+			if ( errno == EINTR ) continue;
+			return false;
+		}
+		while ( n > 0 && ( size_t ) written >= iov -> iov_len ) {
+			written -= iov -> iov_len;
+			iov++;
+			n--;
+		}
+		if ( n > 0 ) {
+			iov -> iov_base = ( char * ) iov -> iov_base + written;
+			iov -> iov_len -= written;
+		}
+	}
+	return true;
+}
+
+#if defined ( __linux__ )
+/**
+ * vmsplice ( ) of one buffer into a pipe, continuing after partial transfers.
+ */
+bool Stream :: spliceAll ( int fd, char * data, size_t bytes ) {
+	while ( bytes > 0 ) {
+		struct iovec iov = { data, bytes };
+		ssize_t moved = vmsplice ( fd, &iov, 1, 0 );
+		if ( moved < 0 ) {
+			if ( errno == EINTR ) continue;
+			return false;
+		}
+		data += moved;
+		bytes -= moved;
+	}
+	return true;
+}
+#endif
+
+/**
+ * Starts the generator threads and writes all chunks to fd in order.
+ *
+ * @return 0 on success or when the reader closed the pipe, 1 on a write error.
+ */
+int Stream :: run ( int fd ) {
+	bool splice = false;
+#if defined ( __linux__ )
+	struct stat st;
+	if ( fstat ( fd, &st ) == 0 && S_ISFIFO ( st.st_mode ) ) {
+		// Pages handed to the pipe stay in use until the reader has consumed them. With a pipe buffer of
+		// exactly one chunk, a chunk has been consumed once the following one has been spliced completely.
+		splice = fcntl ( fd, F_SETPIPE_SZ, ( int ) cfg.chunkBytes ) == ( int ) cfg.chunkBytes;
+	}
+#endif
+
+	std :: vector < std :: thread > workers;
+	for ( unsigned t = 0; t < cfg.threads; t++ ) workers.push_back ( std :: thread ( &Stream :: produce, this, t ) );
+
+	const int MAX_IOV = 16;
+	bool ok = true;
+	for ( ull k = 0; ok && valuesInChunk ( k ) > 0; ) {
+#if defined ( __linux__ )
+		if ( splice ) {
+			Slot & slot = waitFull ( k );
+			ok = spliceAll ( fd, slot.data, slot.bytes );
+			if ( k > 0 ) release ( k - 1 );
+			k++;
+			continue;
+		}
+#endif
+		// write the next chunk together with all chunks after it which are already finished
+		struct iovec iov [ MAX_IOV ];
+		int n = 0;
+		Slot & first = waitFull ( k );
+		iov [ n ].iov_base = first.data;
+		iov [ n ].iov_len = first.bytes;
+		n++;
+		while ( n < MAX_IOV && n < ( int ) slots.size ( ) && valuesInChunk ( k + n ) > 0 ) {
+			Slot & next = slots [ ( k + n ) % slots.size ( ) ];
+			std :: lock_guard < std :: mutex > guard ( next.lock );
+			if ( !next.full ) break;
+			iov [ n ].iov_base = next.data;
+			iov [ n ].iov_len = next.bytes;
+			n++;
+		}
+		ok = writeAll ( fd, iov, n );
+		for ( int i = 0; i < n; i++ ) release ( k + i );
+		k += n;
+	}
+
+	bool readerClosed = !ok && errno == EPIPE;
+	for ( size_t i = 0; i < slots.size ( ); i++ ) {
+		std :: lock_guard < std :: mutex > guard ( slots [ i ].lock );
+		stop = true;
+		slots [ i ].changed.notify_all ( );
+	}
+	for ( unsigned t = 0; t < cfg.threads; t++ ) workers [ t ].join ( );
+
+	if ( !ok && !readerClosed ) {
+		perror ( "icg-stream: write" );
+		return 1;
+	}
+	return 0;
+}
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	Config cfg;
+	cfg.p = 2147483647UL;
+	cfg.a = 16807UL;
+	cfg.b = 1UL;
+	cfg.seed = 12345UL;
+	cfg.type = U32;
+	cfg.count = 0;
+	cfg.chunkBytes = 1 << 20;
+	cfg.threads = std :: thread :: hardware_concurrency ( );
+	cfg.streams = 64;
+	const char * outPath = 0;
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--type" ) == 0 && i + 1 < argc ) {
+			const char * t = argv [ ++i ];
+			if ( strcmp ( t, "u32" ) == 0 ) cfg.type = U32;
+			else if ( strcmp ( t, "double" ) == 0 ) cfg.type = DOUBLE;
+			else if ( strcmp ( t, "normal" ) == 0 ) cfg.type = NORMAL;
+			else {
+				fprintf ( stderr, "unknown type %s\n", t );
+				return 2;
+			}
+		}
+		else if ( strcmp ( argv [ i ], "--count" ) == 0 && i + 1 < argc ) cfg.count = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--out" ) == 0 && i + 1 < argc ) outPath = argv [ ++i ];
+		else if ( strcmp ( argv [ i ], "--threads" ) == 0 && i + 1 < argc ) cfg.threads = ( unsigned ) strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--streams" ) == 0 && i + 1 < argc ) cfg.streams = ( unsigned ) strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--chunk" ) == 0 && i + 1 < argc ) cfg.chunkBytes = ( size_t ) strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--p" ) == 0 && i + 1 < argc ) cfg.p = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--a" ) == 0 && i + 1 < argc ) cfg.a = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--b" ) == 0 && i + 1 < argc ) cfg.b = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--seed" ) == 0 && i + 1 < argc ) cfg.seed = strtoul ( argv [ ++i ], 0, 10 );
+		else {
+			fprintf ( stderr, "usage: %s [--type u32|double|normal] [--count N] [--out file] [--threads N] [--streams S]\n"
+					  "       [--chunk BYTES] [--p P --a A --b B] [--seed S]\n", argv [ 0 ] );
+			return 2;
+		}
+	}
+
+	cfg.valueSize = ( cfg.type == U32 ) ? 4 : 8;
+	if ( cfg.streams == 0 ) cfg.streams = 1;
+	if ( cfg.threads == 0 ) cfg.threads = 1;
+	if ( cfg.threads > cfg.streams ) cfg.threads = cfg.streams;
+	while ( cfg.streams % cfg.threads != 0 ) cfg.threads--;
+	// whole pages, so buffers can be spliced, and at least one value
+	cfg.chunkBytes = ( cfg.chunkBytes + 4095 ) / 4096 * 4096;
+	if ( cfg.chunkBytes == 0 ) cfg.chunkBytes = 4096;
+
+	ICG check ( cfg.p, cfg.a, cfg.b, cfg.seed % cfg.p );
+	if ( !check.isValid ( ) ) {
+		fprintf ( stderr, "invalid generator parameters p=%lu a=%lu b=%lu\n", cfg.p, cfg.a, cfg.b );
+		return 1;
+	}
+	cfg.seed %= cfg.p;
+
+	int fd = 1;
+	if ( outPath ) {
+		fd = open ( outPath, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+		if ( fd < 0 ) {
+			fprintf ( stderr, "cannot open %s\n", outPath );
+			return 1;
+		}
+	}
+	signal ( SIGPIPE, SIG_IGN );	// a reader that has seen enough is reported as EPIPE
+
+	Stream stream ( cfg );
+	if ( !stream.isValid ( ) ) {
+		fprintf ( stderr, "cannot allocate %u buffers of %zu bytes\n", 2 * cfg.threads, cfg.chunkBytes );
+		return 1;
+	}
+	int status = stream.run ( fd );
+
+	if ( outPath ) close ( fd );
+	return status;
+}
@@ -0,0 +1,132 @@
+/**
+ * icg-table: writes a columnar synthetic table generated with all cores (see ICGTable.h).
+ *
+ * 	icg-table --out FILE --rows N --column SPEC [--column SPEC ...] [--threads N] [--row-group-rows N]
+ * 	          [--p P --a A --b B] [--seed S]
+ *
+ * A column SPEC is one of
+ *
+ * 	NAME:int:LO:HI           uniform int64 in LO..HI
+ * 	NAME:interval:LO:HI      uniform double in [ LO, HI )
+ * 	NAME:normal:MU:SIGMA     normal double
+ * 	NAME:zipf:N:S            Zipf int64 rank in 1..N with exponent S
+ * 	NAME:cat:A=W|B=W|...     int32 category index with weights W (A|B|... for equal weights)
+ *
+ * e.g. icg-table --out sales.tbl --rows 10000000000 --column customer:int:1:1000000
+ *                --column product:zipf:50000:1.1 --column price:interval:1:500
+ *                --column region:cat:north=4|south=3|east=2|west=1
+ *
+ * The default generator uses the prime 2^61 - 1, whose period leaves room for 10^10 row tables.
+ *
+ * Build from the repository root:
+ *
+ * 	g++ -O2 -std=c++11 -pthread -I. tools/ICGTable.cpp ICGTable.cpp ICG.cpp -o icg-table
+ */
+
+#include "ICGTable.h"
+#include <stdio.h> // using: printf ( ), fprintf ( )
+#include <stdlib.h> // using: strtoul ( ), strtoull ( ), strtoll ( ), strtod ( )
+#include <string.h> // using: strcmp ( )
+#include <chrono> // using: std::chrono::steady_clock
+#include <string> // using: std::string
+#include <vector> // using: std::vector
+
+namespace {
+
+std :: vector < std :: string > split ( const std :: string & s, char sep ) {
+	std :: vector < std :: string > parts;
+	size_t start = 0;
+	for ( size_t i = 0; i <= s.size ( ); i++ ) {
+		if ( i == s.size ( ) || s [ i ] == sep ) {
+			parts.push_back ( s.substr ( start, i - start ) );
+			start = i + 1;
+		}
+	}
+	return parts;
+}
+
+/**
+ * Adds the column described by spec to table.
+ *
+ * @return False if the spec is malformed or rejected by ICGTable.
+ */
+bool addColumn ( ICGTable & table, const std :: string & spec ) {
+	std :: vector < std :: string > f = split ( spec, ':' );
+	if ( f.size ( ) < 3 || f [ 0 ].empty ( ) ) return false;
+	const std :: string & name = f [ 0 ], & type = f [ 1 ];
+
+	if ( type == "cat" && f.size ( ) == 3 ) {
+		std :: vector < std :: string > names;
+		std :: vector < double > weights;
+		std :: vector < std :: string > items = split ( f [ 2 ], '|' );
+		for ( size_t i = 0; i < items.size ( ); i++ ) {
+			size_t eq = items [ i ].find ( '=' );
+			names.push_back ( items [ i ].substr ( 0, eq ) );
+			weights.push_back ( eq == std :: string :: npos ? 1.0 : strtod ( items [ i ].c_str ( ) + eq + 1, 0 ) );
+		}
+		return table.addCategorical ( name, names, weights );
+	}
+	if ( f.size ( ) != 4 ) return false;
+	if ( type == "int" ) return table.addUniformInt ( name, strtoll ( f [ 2 ].c_str ( ), 0, 10 ), strtoll ( f [ 3 ].c_str ( ), 0, 10 ) );
+	if ( type == "zipf" ) return table.addZipf ( name, strtoll ( f [ 2 ].c_str ( ), 0, 10 ), strtod ( f [ 3 ].c_str ( ), 0 ) );
+
+	double x = strtod ( f [ 2 ].c_str ( ), 0 ), y = strtod ( f [ 3 ].c_str ( ), 0 );
+	if ( type == "interval" ) return table.addInterval ( name, x, y );
+	if ( type == "normal" ) return table.addNormal ( name, x, y );
+	return false;
+}
+
+int usage ( const char * argv0 ) {
+	fprintf ( stderr, "usage: %s --out FILE --rows N --column SPEC [--column SPEC ...] [--threads N] [--row-group-rows N]\n"
+			  "       [--p P --a A --b B] [--seed S]\n"
+			  "SPEC: NAME:int:LO:HI | NAME:interval:LO:HI | NAME:normal:MU:SIGMA | NAME:zipf:N:S | NAME:cat:A=W|B=W|...\n", argv0 );
+	return 2;
+}
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	unsigned long p = 2305843009213693951UL, a = 1234567UL, b = 1UL, seed = 12345UL;
+	unsigned long long rows = 0, groupRows = ICGTable :: DEFAULT_ROW_GROUP_ROWS;
+	unsigned threads = 0;
+	const char * outPath = 0;
+	std :: vector < std :: string > specs;
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--out" ) == 0 && i + 1 < argc ) outPath = argv [ ++i ];
+		else if ( strcmp ( argv [ i ], "--rows" ) == 0 && i + 1 < argc ) rows = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--column" ) == 0 && i + 1 < argc ) specs.push_back ( argv [ ++i ] );
+		else if ( strcmp ( argv [ i ], "--threads" ) == 0 && i + 1 < argc ) threads = ( unsigned ) strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--row-group-rows" ) == 0 && i + 1 < argc ) groupRows = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--p" ) == 0 && i + 1 < argc ) p = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--a" ) == 0 && i + 1 < argc ) a = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--b" ) == 0 && i + 1 < argc ) b = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--seed" ) == 0 && i + 1 < argc ) seed = strtoul ( argv [ ++i ], 0, 10 );
+		else return usage ( argv [ 0 ] );
+	}
+	if ( !outPath || specs.empty ( ) ) return usage ( argv [ 0 ] );
+
+	ICGTable table ( p, a, b, seed );
+	table.setRowGroupRows ( groupRows );
+	for ( size_t i = 0; i < specs.size ( ); i++ ) {
+		if ( !addColumn ( table, specs [ i ] ) ) {
+			fprintf ( stderr, "invalid column %s\n", specs [ i ].c_str ( ) );
+			return 2;
+		}
+	}
+	if ( ( double ) rows * specs.size ( ) >= ( double ) p ) {
+		fprintf ( stderr, "note: rows * columns exceeds p=%lu, column chunks will share parts of the sequence\n", p );
+	}
+
+	std :: chrono :: steady_clock :: time_point start = std :: chrono :: steady_clock :: now ( );
+	if ( !table.write ( outPath, rows, threads ) ) {
+		fprintf ( stderr, "cannot write %s (invalid generator parameters or I/O error)\n", outPath );
+		return 1;
+	}
+	std :: chrono :: duration < double > elapsed = std :: chrono :: steady_clock :: now ( ) - start;
+
+	double values = ( double ) rows * specs.size ( );
+	printf ( "%s: %llu rows x %zu columns in %.2f s, %.0f values/sec\n", outPath, rows, specs.size ( ), elapsed.count ( ),
+			 values / elapsed.count ( ) );
+	return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * icg-tape: creates and inspects pre-generated random tapes (see ICGTape.h).
+ *
+ * 	icg-tape create FILE --count N [--type u32|double|normal] [--p P --a A --b B] [--seed S]
+ * 	                     [--offset K] [--threads N] [--segments N]
+ * 	icg-tape info FILE
+ *
+ * create reports the generation rate. info prints the header, verifies the checksum and reports the
+ * rate at which the mapped tape can be read, which is what a replaying benchmark gets.
+ *
+ * Build from the repository root:
+ *
+ * 	g++ -O2 -std=c++11 -pthread -I. tools/ICGTape.cpp ICGTape.cpp ICG.cpp -o icg-tape
+ */
+
+#include "ICGTape.h"
+#include <stdio.h> // using: printf ( ), fprintf ( )
+#include <stdlib.h> // using: strtoul ( ), strtoull ( )
+#include <string.h> // using: strcmp ( )
+#include <chrono> // using: std::chrono::steady_clock
+#include <thread> // using: std::thread
+
+namespace {
+
+const char * typeName ( ICGTape :: ValueType type ) {
+	return type == ICGTape :: U32 ? "u32" : type == ICGTape :: DOUBLE ? "double" : "normal";
+}
+
+double secondsSince ( std :: chrono :: steady_clock :: time_point start ) {
+	std :: chrono :: duration < double > elapsed = std :: chrono :: steady_clock :: now ( ) - start;
+	return elapsed.count ( );
+}
+
+int usage ( const char * argv0 ) {
+	fprintf ( stderr, "usage: %s create FILE --count N [--type u32|double|normal] [--p P --a A --b B] [--seed S]\n"
+			  "                 [--offset K] [--threads N] [--segments N]\n"
+			  "       %s info FILE\n", argv0, argv0 );
+	return 2;
+}
+
+int create ( int argc, char * * argv ) {
+	const char * path = argv [ 2 ];
+	unsigned long p = 2147483647UL, a = 16807UL, b = 1UL, seed = 12345UL;
+	unsigned long long offset = 0, count = 0;
+	unsigned threads = 0, segments = ICGTape :: DEFAULT_SEGMENTS;
+	ICGTape :: ValueType type = ICGTape :: U32;
+
+	for ( int i = 3; i < argc; i++ ) {
+		if ( strcmp ( argv [ i ], "--type" ) == 0 && i + 1 < argc ) {
+			const char * t = argv [ ++i ];
+			if ( strcmp ( t, "u32" ) == 0 ) type = ICGTape :: U32;
+			else if ( strcmp ( t, "double" ) == 0 ) type = ICGTape :: DOUBLE;
+			else if ( strcmp ( t, "normal" ) == 0 ) type = ICGTape :: NORMAL;
+			else return usage ( argv [ 0 ] );
+		}
+		else if ( strcmp ( argv [ i ], "--count" ) == 0 && i + 1 < argc ) count = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--p" ) == 0 && i + 1 < argc ) p = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--a" ) == 0 && i + 1 < argc ) a = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--b" ) == 0 && i + 1 < argc ) b = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--seed" ) == 0 && i + 1 < argc ) seed = strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--offset" ) == 0 && i + 1 < argc ) offset = strtoull ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--threads" ) == 0 && i + 1 < argc ) threads = ( unsigned ) strtoul ( argv [ ++i ], 0, 10 );
+		else if ( strcmp ( argv [ i ], "--segments" ) == 0 && i + 1 < argc ) segments = ( unsigned ) strtoul ( argv [ ++i ], 0, 10 );
+		else return usage ( argv [ 0 ] );
+	}
+	if ( count == 0 ) return usage ( argv [ 0 ] );
+
+	std :: chrono :: steady_clock :: time_point start = std :: chrono :: steady_clock :: now ( );
+	if ( !ICGTape :: create ( path, p, a, b, seed, offset, type, count, threads, segments ) ) {
+		fprintf ( stderr, "cannot create %s (invalid parameters or I/O error)\n", path );
+		return 1;
+	}
+	double seconds = secondsSince ( start );
+	printf ( "%s: %llu %s values in %.2f s, %.0f values/sec\n", path, count, typeName ( type ), seconds, count / seconds );
+	return 0;
+}
+
+int info ( const char * path ) {
+	ICGTape tape;
+	std :: chrono :: steady_clock :: time_point start = std :: chrono :: steady_clock :: now ( );
+	if ( !tape.open ( path ) ) {
+		fprintf ( stderr, "%s is not a readable tape\n", path );
+		return 1;
+	}
+	double mapSeconds = secondsSince ( start );
+
+	printf ( "type      %s\n", typeName ( tape.get_type ( ) ) );
+	printf ( "count     %llu\n", tape.count ( ) );
+	printf ( "p a b     %lu %lu %lu\n", tape.get_p ( ), tape.get_a ( ), tape.get_b ( ) );
+	printf ( "seed      %lu\n", tape.get_seed ( ) );
+	printf ( "offset    %llu\n", tape.get_offset ( ) );
+	printf ( "segments  %u\n", tape.get_segments ( ) );
+	printf ( "mapped in %.3f s\n", mapSeconds );
+
+	start = std :: chrono :: steady_clock :: now ( );
+	bool ok = tape.verify ( );
+	printf ( "checksum  %s (%.3f s)\n", ok ? "ok" : "MISMATCH", secondsSince ( start ) );
+
+	// a single-threaded pass over the values, as a replaying consumer would make
+	start = std :: chrono :: steady_clock :: now ( );
+	double sum = 0.0;
+	if ( tape.u32 ( ) ) {
+		const unsigned int * v = tape.u32 ( );
+		for ( unsigned long long i = 0; i < tape.count ( ); i++ ) sum += v [ i ];
+	} else {
+		const double * v = tape.doubles ( );
+		for ( unsigned long long i = 0; i < tape.count ( ); i++ ) sum += v [ i ];
+	}
+	double seconds = secondsSince ( start );
+	printf ( "replay    %.0f values/sec (mean %.6g)\n", tape.count ( ) / seconds, tape.count ( ) ? sum / tape.count ( ) : 0.0 );
+
+	return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main ( int argc, char * * argv ) {
+	if ( argc >= 3 && strcmp ( argv [ 1 ], "create" ) == 0 ) return create ( argc, argv );
+	if ( argc == 3 && strcmp ( argv [ 1 ], "info" ) == 0 ) return info ( argv [ 2 ] );
+	return usage ( argv [ 0 ] );
+}